@@ -3,6 +3,7 @@
  */
 
 #include "darknet.hpp"
+#include "darknet_motion.hpp"
 
 /** @file
  * This application will process one or more videos as fast as possible on a single thread and save a new output video
@@ -24,6 +25,10 @@
  *     -> processed frame rate ..... 383.536015 FPS
  *     -> total objects founds ..... 6189
  *     -> average objects/frame .... 5.031707
+ *     -> frames skipped (no motion)  0
+ *     -> frames cropped to motion . 0
+ *
+ * Frames are given to a @ref Darknet::MotionGate, so the neural network is not called when nothing in the video moves.
  */
 
 
@@ -80,6 +85,7 @@ int main(int argc, char * argv[])
 
 				size_t frame_counter = 0;
 				size_t total_objects_found = 0;
+				Darknet::MotionGate motion_gate(net);
 				const auto timestamp_when_video_started = std::chrono::high_resolution_clock::now();
 
 				while (true)
@@ -91,7 +97,8 @@ int main(int argc, char * argv[])
 						break;
 					}
 
-					const auto results = Darknet::predict_and_annotate(net, mat);
+					const auto results = motion_gate.predict(mat);
+					Darknet::annotate(net, results, mat);
 					out.write(mat);
 					frame_counter ++;
 					total_objects_found += results.size();
@@ -116,7 +123,9 @@ int main(int argc, char * argv[])
 					<< "-> time to process video .... " << processing_time_in_milliseconds << " milliseconds"		<< std::endl
 					<< "-> processed frame rate ..... " << final_fps << " FPS"										<< std::endl
 					<< "-> total objects founds ..... " << total_objects_found										<< std::endl
-					<< "-> average objects/frame .... " << static_cast<float>(total_objects_found) / frame_counter	<< std::endl;
+					<< "-> average objects/frame .... " << static_cast<float>(total_objects_found) / frame_counter	<< std::endl
+					<< "-> frames skipped (no motion) " << motion_gate.frames_skipped()								<< std::endl
+					<< "-> frames cropped to motion . " << motion_gate.frames_cropped()								<< std::endl;
 			}
 		}
 
@@ -5,7 +5,8 @@
 #include "darknet.hpp"
 #include "darknet_image.hpp"
 
-#include <set>
+#include "darknet_queue.hpp"
+
 #include <thread>
 
 /** @file
@@ -38,63 +39,52 @@ struct Frame
 {
 	size_t					index;			///< zero-based frame index into the video
 	cv::Mat					mat;			///< the original frame, and then the annotated frame
-	Darknet::Image			img;			///< Darknet-specific image, resized original frame
+	Darknet::Image			img = {};		///< Darknet-specific image, resized original frame
 	Darknet::Predictions	predictions;	///< all predictions made by Darknet/YOLO for this frame
+};
+
 
-	/// std::set uses @p operator<() to ensure the frames are ordered numerically within the set
-	bool operator<(const Frame & rhs) const
+/* Each stage of the pipeline has a single thread, and each thread passes frames to the next stage through a bounded
+ * queue.  Since the queues are FIFO and each stage is handled by a single thread, the frames remain in order and the
+ * output thread doesn't need to re-order anything.  The queues being bounded is also what stops the reader from
+ * getting too far ahead of the other threads.
+ */
+struct Queues
+{
+	static constexpr size_t max_frames_per_queue = 4;
+
+	Darknet::BoundedQueue<Frame> frames_waiting_for_resize		{max_frames_per_queue};	///< once a frame is read from the video, it is stored here
+	Darknet::BoundedQueue<Frame> frames_waiting_for_prediction	{max_frames_per_queue};	///< once a frame has been resized, it is stored here
+	Darknet::BoundedQueue<Frame> frames_waiting_for_output		{max_frames_per_queue};	///< once a frame has been predicted, it is stored here
+
+	/// If something goes wrong, closing all the queues will cause every thread to exit.
+	void close_all()
 	{
-		return index < rhs.index;
+		frames_waiting_for_resize		.close();
+		frames_waiting_for_prediction	.close();
+		frames_waiting_for_output		.close();
 	}
 };
 
 
-bool				all_threads_must_exit	= false;	///< if something goes wrong, this flag gets set to @p true
 Darknet::NetworkPtr	net						= nullptr;	///< Darknet/YOLO neural network pointer
 cv::Size			network_dimensions;					///< dimensions of the neural network that was loaded
-std::set<Frame>		frames_waiting_for_resize;			///< once a frame is read from the video, it is stored here
-std::set<Frame>		frames_waiting_for_prediction;		///< once a frame has been resized, it is stored here
-std::set<Frame>		frames_waiting_for_output;			///< once a frame has been predicted, it is stored here
-std::mutex			waiting_for_resize;					///< mutex to protect access to @ref frames_waiting_for_resize
-std::mutex			waiting_for_prediction;				///< mutex to protect access to @ref frames_waiting_for_prediction
-std::mutex			waiting_for_output;					///< mutex to protect access to @ref frames_waiting_for_output
 std::chrono::high_resolution_clock::duration wait_threads_duration;	///< amount of time spent waiting for other threads to finish running
 std::chrono::high_resolution_clock::duration reader_work_duration;	///< amount of time spent reading frames
 std::chrono::high_resolution_clock::duration resize_work_duration;	///< amount of time spent resizing frames
 std::chrono::high_resolution_clock::duration predict_work_duration;	///< amount of time spent predicting frames
 std::chrono::high_resolution_clock::duration output_work_duration;	///< amount of time spent on the output video
-size_t				reader_must_pause		= 0;
-size_t				resize_thread_starved	= 0;
-size_t				predict_thread_starved	= 0;
-size_t				output_thread_starved	= 0;
-size_t				waiting_for_threads		= 0;
-size_t				expected_next_index		= 0; ///< keep track of which frame has been written to disk
 
 
-void resize_thread()
+void resize_thread(Queues & queues)
 {
+	Frame frame;
 	try
 	{
-		while (all_threads_must_exit == false)
+		while (queues.frames_waiting_for_resize.pop(frame))
 		{
-			if ( frames_waiting_for_resize.empty())
-			{
-				resize_thread_starved ++;
-				std::this_thread::sleep_for(std::chrono::milliseconds(1));
-				continue;
-			}
-
 			const auto timestamp_begin = std::chrono::high_resolution_clock::now();
 
-			Frame frame;
-			if (true)
-			{
-				std::scoped_lock lock(waiting_for_resize);
-				auto iter = frames_waiting_for_resize.begin();
-				frame = *iter;
-				frames_waiting_for_resize.erase(iter);
-			}
-
 			cv::Mat tmp;
 			if (frame.mat.size() == network_dimensions)
 			{
@@ -112,113 +102,80 @@ void resize_thread()
 
 			frame.img = Darknet::mat_to_image(tmp);
 
-			if (true)
+			const auto timestamp_end = std::chrono::high_resolution_clock::now();
+			resize_work_duration += timestamp_end - timestamp_begin;
+
+			if (not queues.frames_waiting_for_prediction.push(std::move(frame)))
 			{
-				std::scoped_lock lock(waiting_for_prediction);
-				frames_waiting_for_prediction.insert(frame);
+				// the queue was closed because one of the threads ran into a problem
+				break;
 			}
 
-			const auto timestamp_end = std::chrono::high_resolution_clock::now();
-			resize_work_duration += timestamp_end - timestamp_begin;
+			// the image now belongs to the detection thread
+			frame.img = {};
 		}
 	}
 	catch(const std::exception & e)
 	{
 		std::cout << "ERROR: resize thread exception: " << e.what() << std::endl;
-		all_threads_must_exit = true;
+		queues.close_all();
 	}
 
+	// if the frame was not handed over to the next thread, then the image still belongs to us
+	Darknet::free_image(frame.img);
+
+	// let the next thread know that no more frames are coming
+	queues.frames_waiting_for_prediction.close();
+
 	return;
 }
 
 
-void detection_thread(size_t & total_objects_found)
+void detection_thread(Queues & queues, size_t & total_objects_found)
 {
+	Frame frame;
 	try
 	{
-		while (all_threads_must_exit == false)
+		while (queues.frames_waiting_for_prediction.pop(frame))
 		{
-			if (frames_waiting_for_prediction.empty())
-			{
-				predict_thread_starved ++;
-				std::this_thread::sleep_for(std::chrono::milliseconds(1));
-				continue;
-			}
-
-			// if we get here we know we have at least 1 frame where we can call predict()
 			const auto timestamp_begin = std::chrono::high_resolution_clock::now();
 
-			Frame frame;
-			if (true)
-			{
-				std::scoped_lock lock(waiting_for_prediction);
-				auto iter = frames_waiting_for_prediction.begin();
-				frame = *iter;
-				frames_waiting_for_prediction.erase(iter);
-			}
-
 			frame.predictions = Darknet::predict(net, frame.img, frame.mat.size());
 			Darknet::annotate(net, frame.predictions, frame.mat);
 
 			total_objects_found += frame.predictions.size();
 
-			// in case multiple resize threads are running, we have no idea in which order the frames have been processed,
-			// so pass them to another thread which will ensure the frames are re-ordered before creating the output video
-			std::scoped_lock lock(waiting_for_output);
-			frames_waiting_for_output.insert(frame);
-
 			const auto timestamp_end = std::chrono::high_resolution_clock::now();
 			predict_work_duration += timestamp_end - timestamp_begin;
+
+			queues.frames_waiting_for_output.push(std::move(frame));
 		}
 	}
 	catch(const std::exception & e)
 	{
 		std::cout << "ERROR: detection thread exception: " << e.what() << std::endl;
-		all_threads_must_exit = true;
+		queues.close_all();
 	}
 
+	// predict() frees the image, but not if something went wrong before the frame was predicted
+	Darknet::free_image(frame.img);
+
+	queues.frames_waiting_for_output.close();
+
 	return;
 }
 
 
-void output_thread(cv::VideoWriter & out)
+void output_thread(Queues & queues, cv::VideoWriter & out)
 {
 	try
 	{
-		expected_next_index = 0;
-
-		while (all_threads_must_exit == false)
+		Frame frame;
+		while (queues.frames_waiting_for_output.pop(frame))
 		{
-			if ( frames_waiting_for_output.empty())
-			{
-				output_thread_starved ++;
-				std::this_thread::sleep_for(std::chrono::milliseconds(1));
-				continue;
-			}
-
-			// we have at least 1 frame ready...but is it the right one?
-
-			if (frames_waiting_for_output.begin()->index != expected_next_index)
-			{
-				output_thread_starved ++;
-				std::this_thread::yield();
-				continue;
-			}
-
-			// if we get here, then the next frame we want is at the front of the set
 			const auto timestamp_begin = std::chrono::high_resolution_clock::now();
 
-			Frame frame;
-			if (true)
-			{
-				std::scoped_lock lock(waiting_for_output);
-				auto iter = frames_waiting_for_output.begin();
-				frame = *iter;
-				frames_waiting_for_output.erase(iter);
-			}
-
 			out.write(frame.mat);
-			expected_next_index ++;
 
 			const auto timestamp_end = std::chrono::high_resolution_clock::now();
 			output_work_duration += timestamp_end - timestamp_begin;
@@ -230,7 +187,7 @@ void output_thread(cv::VideoWriter & out)
 	catch(const std::exception & e)
 	{
 		std::cout << "ERROR: output thread exception: " << e.what() << std::endl;
-		all_threads_must_exit = true;
+		queues.close_all();
 	}
 
 	return;
@@ -287,12 +244,6 @@ int main(int argc, char * argv[])
 			resize_work_duration	= std::chrono::high_resolution_clock::duration();
 			predict_work_duration	= std::chrono::high_resolution_clock::duration();
 			output_work_duration	= std::chrono::high_resolution_clock::duration();
-			reader_must_pause		= 0;
-			resize_thread_starved	= 0;
-			predict_thread_starved	= 0;
-			output_thread_starved	= 0;
-			waiting_for_threads		= 0;
-			expected_next_index		= 0;
 
 			cv::VideoWriter out(output_filename, cv::VideoWriter::fourcc('m', 'p', '4', 'v'), fps, cv::Size(video_width, video_height));
 			if (not out.isOpened())
@@ -312,14 +263,15 @@ int main(int argc, char * argv[])
 				* resizing take a bit more time than reading, predicting takes more time than resizing, and the longest of all is
 				* writing the video back to disk because of the re-encoding.
 				*
-				* By rate limiting the first and fastest task, we can control the rest of the tasks after that.
+				* Because the queues between each task are bounded, the first and fastest task will block when it gets too far
+				* ahead, which in turn controls the rest of the tasks after that.
 				*/
 
 			// start all the threads we'll need -- the "main" thread will take care of task #1 (reading)
-			all_threads_must_exit = false;
-			threads.emplace_back(resize_thread);									// task #2
-			threads.emplace_back(detection_thread, std::ref(total_objects_found));	// task #3
-			threads.emplace_back(output_thread, std::ref(out));						// task #4
+			Queues queues;
+			threads.emplace_back(resize_thread, std::ref(queues));										// task #2
+			threads.emplace_back(detection_thread, std::ref(queues), std::ref(total_objects_found));	// task #3
+			threads.emplace_back(output_thread, std::ref(queues), std::ref(out));						// task #4
 
 			std::cout
 				<< "-> total number of CPUs ..... " << std::thread::hardware_concurrency()			<< std::endl
@@ -333,7 +285,7 @@ int main(int argc, char * argv[])
 
 			const auto timestamp_when_video_started = std::chrono::high_resolution_clock::now();
 
-			while (all_threads_must_exit == false)
+			while (true)
 			{
 				const auto timestamp_begin = std::chrono::high_resolution_clock::now();
 
@@ -345,11 +297,14 @@ int main(int argc, char * argv[])
 					break;
 				}
 
-				// place the frame on the queue so it can be resized
-				if (true)
+				const auto timestamp_end = std::chrono::high_resolution_clock::now();
+				reader_work_duration += timestamp_end - timestamp_begin;
+
+				// place the frame on the queue so it can be resized -- this blocks if the other threads cannot keep up
+				if (not queues.frames_waiting_for_resize.push(std::move(frame)))
 				{
-					std::scoped_lock lock(waiting_for_resize);
-					frames_waiting_for_resize.insert(frame);
+					// queue was closed because one of the threads ran into a problem
+					break;
 				}
 
 				frame_counter ++;
@@ -361,30 +316,25 @@ int main(int argc, char * argv[])
 						<< " (" << percentage << "%)\r"
 						<< std::flush;
 				}
-
-				const auto timestamp_end = std::chrono::high_resolution_clock::now();
-				reader_work_duration += timestamp_end - timestamp_begin;
-
-				while (	all_threads_must_exit == false and
-						frames_waiting_for_resize		.size() +
-						frames_waiting_for_prediction	.size() +
-						frames_waiting_for_output		.size() > 5)
-				{
-					// reader thread is getting too far ahead of the other threads, we need to slow down
-					reader_must_pause ++;
-					std::this_thread::sleep_for(std::chrono::milliseconds(1));
-				}
 			}
 
 			// even though we finished reading the frames from the input video, the other threads may not yet have finished
+			// so close the first queue and let each thread drain what is left before it exits
 			const auto begin_waiting = std::chrono::high_resolution_clock::now();
-			while (all_threads_must_exit == false and expected_next_index < frame_counter)
+			queues.frames_waiting_for_resize.close();
+			for (auto & t : threads)
+			{
+				t.join();
+			}
+			threads.clear();
+
+			// if a thread stopped early, there may be resized frames which were never predicted
+			Frame leftover;
+			while (queues.frames_waiting_for_prediction.try_pop(leftover))
 			{
-				waiting_for_threads ++;
-				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				Darknet::free_image(leftover.img);
 			}
 			wait_threads_duration = std::chrono::high_resolution_clock::now() - begin_waiting;
-			all_threads_must_exit = true;
 
 			const auto timestamp_when_video_ended = std::chrono::high_resolution_clock::now();
 			const auto processing_duration = timestamp_when_video_ended - timestamp_when_video_started;
@@ -399,11 +349,6 @@ int main(int argc, char * argv[])
 				<< "-> average objects/frame .... " << static_cast<float>(total_objects_found) / frame_counter	<< std::endl
 #if 0
 				// timing details are commented out, they're mostly for development purpose not end user consumption
-				<< "-> reader chose to pause .... " << reader_must_pause										<< std::endl
-				<< "-> resize thread starved .... " << resize_thread_starved									<< std::endl
-				<< "-> predict thread starved ... " << predict_thread_starved									<< std::endl
-				<< "-> output thread starved .... " << output_thread_starved									<< std::endl
-				<< "-> waiting for threads ...... " << waiting_for_threads										<< std::endl
 				<< "-> time spent reading ....... " << std::chrono::duration_cast<std::chrono::milliseconds>(reader_work_duration).count() << " milliseconds" << std::endl
 				<< "-> time spent resizing ...... " << std::chrono::duration_cast<std::chrono::milliseconds>(resize_work_duration).count() << " milliseconds" << std::endl
 				<< "-> time spent predicting .... " << std::chrono::duration_cast<std::chrono::milliseconds>(predict_work_duration).count() << " milliseconds" << std::endl
@@ -411,13 +356,6 @@ int main(int argc, char * argv[])
 				<< "-> time waiting for threads . " << std::chrono::duration_cast<std::chrono::milliseconds>(wait_threads_duration).count() << " milliseconds" << std::endl
 #endif
 				;
-
-			// all threads should have exited by now
-			for (auto & t : threads)
-			{
-				t.join();
-			}
-			threads.clear();
 		}
 
 		Darknet::free_neural_network(net);
@@ -3,6 +3,7 @@
  */
 
 #include "darknet.hpp"
+#include "darknet_motion.hpp"
 
 /** @file
  * This application will read from a RTP stream, run the video through Darknet/YOLO, and display the results.
@@ -18,6 +19,9 @@
  * ~~~~{.sh}
  *		cvlc -vvv v4l2:///dev/video0 :v4l2-width=1280 :v4l2-height=720 :v4l2-fps=30 --sout '#transcode{vcodec=mp2v,width=1280,height=720,acodec=none}:rtp{dst=239.0.0.1,port=43210,mux=ts}'
  * ~~~~
+ *
+ * Since cameras are often pointed at a static scene, the frames go through a @ref Darknet::MotionGate.  The neural
+ * network only runs when something in the frame has moved.
  */
 
 
@@ -90,6 +94,7 @@ int main(int argc, char * argv[])
 		size_t frame_counter				= 0;
 		size_t total_objects_found			= 0;
 		size_t recent_error_counter			= 0;
+		Darknet::MotionGate motion_gate(net);
 		double total_sleep_in_milliseconds	= 0.0;
 		const auto timestamp_when_stream_started = std::chrono::high_resolution_clock::now();
 
@@ -107,7 +112,8 @@ int main(int argc, char * argv[])
 			}
 			recent_error_counter = 0;
 
-			const auto results = Darknet::predict_and_annotate(net, mat);
+			const auto results = motion_gate.predict(mat);
+			Darknet::annotate(net, results, mat);
 			cv::imshow(stream, mat);
 			frame_counter ++;
 			total_objects_found += results.size();
@@ -140,7 +146,9 @@ int main(int argc, char * argv[])
 			<< "-> total length of stream ... " << video_length_in_milliseconds << " milliseconds"					<< std::endl
 			<< "-> processed frame rate ..... " << final_fps << " FPS"												<< std::endl
 			<< "-> total objects founds ..... " << total_objects_found												<< std::endl
-			<< "-> average objects/frame .... " << static_cast<float>(total_objects_found) / frame_counter			<< std::endl;
+			<< "-> average objects/frame .... " << static_cast<float>(total_objects_found) / frame_counter			<< std::endl
+			<< "-> frames skipped (no motion) " << motion_gate.frames_skipped()										<< std::endl
+			<< "-> frames cropped to motion . " << motion_gate.frames_cropped()										<< std::endl;
 
 		Darknet::free_neural_network(net);
 	}
@@ -0,0 +1,98 @@
+/* Darknet/YOLO:  https://github.com/hank-ai/darknet
+ * Copyright 2024 Stephane Charette
+ */
+
+#include "darknet.hpp"
+#include "darknet_stream_mux.hpp"
+
+/** @file
+ * This application runs a single neural network on several video streams at once.  The streams can be video files,
+ * RTP or RTSP URLs, or generated test patterns.  For example:
+ *
+ *     darknet_11_multiple_streams LegoGears DSCN1580_frame_000034.MOV DSCN1582A.MOV rtsp://192.168.1.10/stream testpattern:1280x720@30
+ *
+ * Frames are decoded on a shared set of threads and given to the neural network in batches.  When the network cannot
+ * keep up with a live stream, the oldest frames are dropped.  The results are not shown to the user, but a summary is
+ * printed once all the streams have ended (or after 30 seconds when a stream never ends, such as a test pattern).
+ */
+
+
+int main(int argc, char * argv[])
+{
+	try
+	{
+		Darknet::show_version_info();
+
+		Darknet::Parms parms = Darknet::parse_arguments(argc, argv);
+		Darknet::NetworkPtr net = Darknet::load_neural_network(parms);
+
+		Darknet::StreamMux mux(net);
+		bool has_live_stream = false;
+		for (const auto & parm : parms)
+		{
+			if (parm.type == Darknet::EParmType::kFilename)
+			{
+				mux.add_stream(parm.string);
+			}
+			else if (parm.type == Darknet::EParmType::kOther and
+				(parm.string.find("rtp") == 0 or parm.string.find("rtsp") == 0 or parm.string.find("testpattern") == 0))
+			{
+				mux.add_stream(parm.string);
+				has_live_stream = true;
+			}
+		}
+
+		if (mux.number_of_streams() == 0)
+		{
+			throw std::invalid_argument("no video files, stream URLs, or test patterns were specified");
+		}
+
+		std::cout << "Processing " << mux.number_of_streams() << " streams..." << std::endl;
+
+		std::vector<size_t> frames(mux.number_of_streams(), 0);
+		std::vector<size_t> objects(mux.number_of_streams(), 0);
+
+		const auto timestamp_start = std::chrono::high_resolution_clock::now();
+		mux.start();
+
+		Darknet::StreamResult result;
+		while (mux.get_result(result))
+		{
+			frames[result.stream_index] ++;
+			objects[result.stream_index] += result.predictions.size();
+
+			if (has_live_stream and std::chrono::high_resolution_clock::now() - timestamp_start > std::chrono::seconds(30))
+			{
+				mux.stop();
+			}
+		}
+
+		const auto duration = std::chrono::high_resolution_clock::now() - timestamp_start;
+		const size_t milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+
+		size_t total_frames = 0;
+		for (size_t idx = 0; idx < mux.number_of_streams(); idx ++)
+		{
+			total_frames += frames[idx];
+			std::cout
+				<< "-> stream #" << idx
+				<< ": frames=" << frames[idx]
+				<< " dropped=" << mux.frames_dropped(idx)
+				<< " objects=" << objects[idx]
+				<< std::endl;
+		}
+
+		std::cout
+			<< "-> total frames processed ... " << total_frames										<< std::endl
+			<< "-> processing time .......... " << milliseconds << " milliseconds"					<< std::endl
+			<< "-> combined frame rate ...... " << 1000.0 * total_frames / std::max<size_t>(1, milliseconds) << " FPS" << std::endl;
+
+		Darknet::free_neural_network(net);
+	}
+	catch (const std::exception & e)
+	{
+		std::cout << "Exception: " << e.what() << std::endl;
+	}
+
+	return 0;
+}
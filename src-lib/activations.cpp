@@ -115,22 +115,19 @@ void activate_array(float *x, const int n, const ACTIVATION a)
 {
 	TAT(TATPARMS);
 
-	int i;
 	if (a == LINEAR) {}
 	else if (a == LEAKY) {
-		#pragma omp parallel for
-		for (i = 0; i < n; ++i) {
+		Darknet::parallel_for(0, n, [&](const int i) {
 			x[i] = leaky_activate(x[i]);
-		}
+		}, 1024);
 	}
 	else if (a == LOGISTIC) {
-		#pragma omp parallel for
-		for (i = 0; i < n; ++i) {
+		Darknet::parallel_for(0, n, [&](const int i) {
 			x[i] = logistic_activate(x[i]);
-		}
+		}, 1024);
 	}
 	else {
-		for (i = 0; i < n; ++i) {
+		for (int i = 0; i < n; ++i) {
 			x[i] = activate(x[i], a);
 		}
 	}
@@ -140,14 +137,12 @@ void activate_array_swish(float *x, const int n, float * output_sigmoid, float *
 {
 	TAT(TATPARMS);
 
-	int i;
-	#pragma omp parallel for
-	for (i = 0; i < n; ++i) {
+	Darknet::parallel_for(0, n, [&](const int i) {
 		float x_val = x[i];
 		float sigmoid = logistic_activate(x_val);
 		output_sigmoid[i] = sigmoid;
 		output[i] = x_val * sigmoid;
-	}
+	}, 1024);
 }
 
 // https://github.com/digantamisra98/Mish
@@ -156,13 +151,11 @@ void activate_array_mish(float *x, const int n, float * activation_input, float
 	TAT(TATPARMS);
 
 	const float MISH_THRESHOLD = 20;
-	int i;
-	#pragma omp parallel for
-	for (i = 0; i < n; ++i) {
+	Darknet::parallel_for(0, n, [&](const int i) {
 		float x_val = x[i];
 		activation_input[i] = x_val;    // store value before activation
 		output[i] = x_val * tanh_activate( softplus_activate(x_val, MISH_THRESHOLD) );
-	}
+	}, 1024);
 }
 
 static float hard_mish_yashas(float x)
@@ -180,13 +173,11 @@ void activate_array_hard_mish(float *x, const int n, float * activation_input, f
 {
 	TAT(TATPARMS);
 
-	int i;
-	#pragma omp parallel for
-	for (i = 0; i < n; ++i) {
+	Darknet::parallel_for(0, n, [&](const int i) {
 		float x_val = x[i];
 		activation_input[i] = x_val;    // store value before activation
 		output[i] = hard_mish_yashas(x_val);
-	}
+	}, 1024);
 }
 
 void activate_array_normalize_channels(float *x, const int n, int batch, int channels, int wh_step, float *output)
@@ -195,9 +186,7 @@ void activate_array_normalize_channels(float *x, const int n, int batch, int cha
 
 	int size = n / channels;
 
-	int i;
-	#pragma omp parallel for
-	for (i = 0; i < size; ++i) {
+	Darknet::parallel_for(0, size, [&](const int i) {
 		int wh_i = i % wh_step;
 		int b = i / wh_step;
 
@@ -216,7 +205,7 @@ void activate_array_normalize_channels(float *x, const int n, int batch, int cha
 				output[wh_i + k * wh_step + b*wh_step*channels] = val;
 			}
 		}
-	}
+	}, 64);
 }
 
 void activate_array_normalize_channels_softmax(float *x, const int n, int batch, int channels, int wh_step, float *output, int use_max_val)
@@ -225,9 +214,7 @@ void activate_array_normalize_channels_softmax(float *x, const int n, int batch,
 
 	int size = n / channels;
 
-	int i;
-	#pragma omp parallel for
-	for (i = 0; i < size; ++i) {
+	Darknet::parallel_for(0, size, [&](const int i) {
 		int wh_i = i % wh_step;
 		int b = i / wh_step;
 
@@ -255,7 +242,7 @@ void activate_array_normalize_channels_softmax(float *x, const int n, int batch,
 				output[wh_i + k * wh_step + b*wh_step*channels] = val;
 			}
 		}
-	}
+	}, 64);
 }
 
 void gradient_array_normalize_channels_softmax(float *x, const int n, int batch, int channels, int wh_step, float *delta)
@@ -264,9 +251,7 @@ void gradient_array_normalize_channels_softmax(float *x, const int n, int batch,
 
 	int size = n / channels;
 
-	int i;
-	#pragma omp parallel for
-	for (i = 0; i < size; ++i) {
+	Darknet::parallel_for(0, size, [&](const int i) {
 		int wh_i = i % wh_step;
 		int b = i / wh_step;
 
@@ -286,7 +271,7 @@ void gradient_array_normalize_channels_softmax(float *x, const int n, int batch,
 				delta[index] = d;
 			}
 		}
-	}
+	}, 64);
 }
 
 void gradient_array_normalize_channels(float *x, const int n, int batch, int channels, int wh_step, float *delta)
@@ -295,9 +280,7 @@ void gradient_array_normalize_channels(float *x, const int n, int batch, int cha
 
 	int size = n / channels;
 
-	int i;
-	#pragma omp parallel for
-	for (i = 0; i < size; ++i) {
+	Darknet::parallel_for(0, size, [&](const int i) {
 		int wh_i = i % wh_step;
 		int b = i / wh_step;
 
@@ -319,7 +302,7 @@ void gradient_array_normalize_channels(float *x, const int n, int batch, int cha
 				}
 			}
 		}
-	}
+	}, 64);
 }
 
 float gradient(float x, ACTIVATION a)
@@ -361,11 +344,9 @@ void gradient_array(const float *x, const int n, const ACTIVATION a, float *delt
 {
 	TAT(TATPARMS);
 
-	int i;
-	#pragma omp parallel for
-	for(i = 0; i < n; ++i){
+	Darknet::parallel_for(0, n, [&](const int i) {
 		delta[i] *= gradient(x[i], a);
-	}
+	}, 1024);
 }
 
 // https://github.com/BVLC/caffe/blob/04ab089db018a292ae48d51732dd6c66766b36b6/src/caffe/layers/swish_layer.cpp#L54-L56
@@ -373,12 +354,10 @@ void gradient_array_swish(const float *x, const int n, const float * sigmoid, fl
 {
 	TAT(TATPARMS);
 
-	int i;
-	#pragma omp parallel for
-	for (i = 0; i < n; ++i) {
+	Darknet::parallel_for(0, n, [&](const int i) {
 		float swish = x[i];
 		delta[i] *= swish + sigmoid[i]*(1 - swish);
-	}
+	}, 1024);
 }
 
 // https://github.com/digantamisra98/Mish
@@ -386,9 +365,7 @@ void gradient_array_mish(const int n, const float * activation_input, float * de
 {
 	TAT(TATPARMS);
 
-	int i;
-	#pragma omp parallel for
-	for (i = 0; i < n; ++i) {
+	Darknet::parallel_for(0, n, [&](const int i) {
 		const float MISH_THRESHOLD = 20.0f;
 
 		// implementation from TensorFlow: https://github.com/tensorflow/addons/commit/093cdfa85d334cbe19a37624c33198f3140109ed
@@ -407,7 +384,7 @@ void gradient_array_mish(const int n, const float * activation_input, float * de
 		//float w = 4 * (x + 1) + 4 * expf(2 * x) + expf(3 * x) + expf(x)*(4 * x + 6);
 		//float derivative = expf(x) * w / (d * d);
 		//delta[i] *= derivative;
-	}
+	}, 1024);
 }
 
 static float hard_mish_yashas_grad(float x)
@@ -425,10 +402,8 @@ void gradient_array_hard_mish(const int n, const float * activation_input, float
 {
 	TAT(TATPARMS);
 
-	int i;
-	#pragma omp parallel for
-	for (i = 0; i < n; ++i) {
+	Darknet::parallel_for(0, n, [&](const int i) {
 		float inp = activation_input[i];
 		delta[i] *= hard_mish_yashas_grad(inp);
-	}
+	}, 1024);
 }
@@ -97,9 +97,7 @@ void shortcut_multilayer_cpu(int size, int src_outputs, int batch, int n, int *o
 	int step = 0;
 	if (nweights > 0) step = src_outputs / layer_step; // (l.c * l.h * l.w) or (l.w*l.h) or 1
 
-	int id;
-	#pragma omp parallel for
-	for (id = 0; id < size; ++id) {
+	Darknet::parallel_for(0, size, [&](const int id) {
 
 		int src_id = id;
 		const int src_i = src_id % src_outputs;
@@ -155,7 +153,7 @@ void shortcut_multilayer_cpu(int size, int src_outputs, int batch, int n, int *o
 				else out[out_index] += add[add_index];
 			}
 		}
-	}
+	}, 16);
 }
 
 void backward_shortcut_multilayer_cpu(int size, int src_outputs, int batch, int n, int *outputs_of_layers,
@@ -168,9 +166,7 @@ void backward_shortcut_multilayer_cpu(int size, int src_outputs, int batch, int
 	int step = 0;
 	if (nweights > 0) step = src_outputs / layer_step; // (l.c * l.h * l.w) or (l.w*l.h) or 1
 
-	int id;
-	#pragma omp parallel for
-	for (id = 0; id < size; ++id) {
+	Darknet::parallel_for(0, size, [&](const int id) {
 		int src_id = id;
 		int src_i = src_id % src_outputs;
 		src_id /= src_outputs;
@@ -239,7 +235,7 @@ void backward_shortcut_multilayer_cpu(int size, int src_outputs, int batch, int
 				else layer_delta[add_index] += delta_in[id];
 			}
 		}
-	}
+	}, 16);
 }
 
 void shortcut_cpu(int batch, int w1, int h1, int c1, float *add, int w2, int h2, int c2, float *out)
@@ -124,6 +124,90 @@ namespace
 
 		return;
 	}
+
+
+	/** Same as @p cv::rectangle() with a thickness of 1 and a non-antialiased line type, but each side is filled as a
+	 * 1-pixel-wide region which OpenCV vectorizes, instead of rasterizing 4 individual lines.
+	 */
+	static inline void draw_box_outline(cv::Mat & mat, const cv::Rect & r, const cv::Scalar & colour)
+	{
+		TAT(TATPARMS);
+
+		if (r.width < 2 or r.height < 2)
+		{
+			cv::rectangle(mat, r, colour, 1, cv::LINE_8);
+			return;
+		}
+
+		const cv::Rect image_rect(0, 0, mat.cols, mat.rows);
+		const cv::Rect sides[] =
+		{
+			cv::Rect(r.x					, r.y					, r.width	, 1			),	// top
+			cv::Rect(r.x					, r.y + r.height - 1	, r.width	, 1			),	// bottom
+			cv::Rect(r.x					, r.y					, 1			, r.height	),	// left
+			cv::Rect(r.x + r.width - 1		, r.y					, 1			, r.height	),	// right
+		};
+
+		for (const auto & side : sides)
+		{
+			const cv::Rect roi = side & image_rect;
+			if (roi.area() > 0)
+			{
+				mat(roi).setTo(colour);
+			}
+		}
+
+		return;
+	}
+
+
+	/** Render the label for this class and confidence, or return the one rendered previously.  Creating a label means
+	 * calling @p cv::getTextSize() and @p cv::putText(), which is much more expensive than copying the pixels.
+	 */
+	static inline Darknet::LabelSprite get_label_sprite(Darknet::NetworkDetails & details, const int class_idx, const int percentage, const int image_type)
+	{
+		TAT(TATPARMS);
+
+		const cv::Scalar & background = details.class_colours.at(class_idx);
+		const cv::Scalar & foreground = details.text_colours.at(class_idx);
+		const auto key = std::make_tuple(class_idx, percentage, image_type);
+
+		std::scoped_lock lock(details.label_sprites_mutex);
+
+		auto iter = details.label_sprites.find(key);
+		if (iter != details.label_sprites.end() and
+			iter->second.background == background and
+			iter->second.foreground == foreground)
+		{
+			// the sprite holds reference-counted images, so this copy is cheap
+			return iter->second;
+		}
+
+		const std::string text = details.class_names.at(class_idx) + " " + std::to_string(percentage) + "%";
+
+		int				font_baseline	= 0;
+		const cv::Size	size			= cv::getTextSize(text, details.cv_font_face, details.cv_font_scale, details.cv_font_thickness, &font_baseline);
+
+		Darknet::LabelSprite sprite;
+		sprite.height		= size.height + font_baseline;
+		sprite.background	= background;
+		sprite.foreground	= foreground;
+
+		// the extra rows at the bottom are for the descenders, which in the past were drawn overlapping the bounding box
+		const cv::Rect label(0, 0, size.width + 2, sprite.height);
+		const cv::Point origin(1, sprite.height - font_baseline / 2);
+		sprite.image	= cv::Mat(sprite.height + font_baseline, label.width, image_type, cv::Scalar::all(0));
+		sprite.mask		= cv::Mat(sprite.image.size(), CV_8UC1, cv::Scalar(0));
+
+		cv::rectangle	(sprite.image	, label			, background	, cv::FILLED, details.cv_line_type);
+		cv::rectangle	(sprite.mask	, label			, 255			, cv::FILLED, details.cv_line_type);
+		cv::putText		(sprite.image	, text, origin	, details.cv_font_face, details.cv_font_scale, foreground		, details.cv_font_thickness, details.cv_line_type);
+		cv::putText		(sprite.mask	, text, origin	, details.cv_font_face, details.cv_font_scale, cv::Scalar(255)	, details.cv_font_thickness, details.cv_line_type);
+
+		details.label_sprites[key] = sprite;
+
+		return sprite;
+	}
 }
 
 
@@ -880,6 +964,103 @@ void Darknet::set_gpu_index(int idx)
 }
 
 
+void Darknet::set_worker_threads(const size_t number_of_threads, const bool pin_to_cores)
+{
+	TAT(TATPARMS);
+
+	Darknet::WorkerPool::configure(number_of_threads, pin_to_cores);
+
+	return;
+}
+
+
+void Darknet::set_thread_budget(Darknet::NetworkPtr ptr, const size_t number_of_threads)
+{
+	TAT(TATPARMS);
+
+	Darknet::Network * net = reinterpret_cast<Darknet::Network*>(ptr);
+	if (net == nullptr)
+	{
+		throw std::invalid_argument("pointer to neural network cannot be NULL");
+	}
+
+	net->details->thread_budget = number_of_threads;
+
+	return;
+}
+
+
+void Darknet::set_concurrent_branches(Darknet::NetworkPtr ptr, const bool toggle)
+{
+	TAT(TATPARMS);
+
+	Darknet::Network * net = reinterpret_cast<Darknet::Network*>(ptr);
+	if (net == nullptr)
+	{
+		throw std::invalid_argument("pointer to neural network cannot be NULL");
+	}
+
+	net->details->concurrent_branches = toggle;
+
+	return;
+}
+
+
+void Darknet::set_resize_mode(Darknet::NetworkPtr ptr, const Darknet::EResizeMode mode)
+{
+	TAT(TATPARMS);
+
+	Darknet::Network * net = reinterpret_cast<Darknet::Network*>(ptr);
+	if (net == nullptr)
+	{
+		throw std::invalid_argument("pointer to neural network cannot be NULL");
+	}
+
+	net->details->resize_mode = mode;
+
+	return;
+}
+
+
+void Darknet::set_tiled_inference(Darknet::NetworkPtr ptr, const bool toggle, const cv::Size & tile_size, const float overlap, const bool full_frame, const int batch_size)
+{
+	TAT(TATPARMS);
+
+	Darknet::Network * net = reinterpret_cast<Darknet::Network*>(ptr);
+	if (net == nullptr)
+	{
+		throw std::invalid_argument("pointer to neural network cannot be NULL");
+	}
+	if (tile_size.width < 0 or tile_size.height < 0)
+	{
+		throw std::invalid_argument("tile size cannot be negative");
+	}
+	if (overlap < 0.0f or overlap > 0.9f)
+	{
+		throw std::invalid_argument("tile overlap must be between 0.0 and 0.9");
+	}
+	if (batch_size < 0)
+	{
+		throw std::invalid_argument("batch size cannot be negative");
+	}
+
+	net->details->tiled_inference	= toggle;
+	net->details->tile_size			= tile_size;
+	net->details->tile_overlap		= overlap;
+	net->details->tile_full_frame	= full_frame;
+
+	if (batch_size > 0 and batch_size != net->batch)
+	{
+		// the layer outputs are sized for the batch, so they need to be re-allocated
+		set_batch_network(net, batch_size);
+		resize_network(net, net->w, net->h);
+		net->details->letterbox_source_size = cv::Size();
+	}
+
+	return;
+}
+
+
 void Darknet::set_detection_threshold(Darknet::NetworkPtr ptr, float threshold)
 {
 	TAT(TATPARMS);
@@ -961,6 +1142,13 @@ void Darknet::set_annotation_font(Darknet::NetworkPtr ptr, const cv::LineTypes l
 	net->details->cv_font_thickness	= font_thickness;
 	net->details->cv_font_scale		= font_scale;
 
+	if (true)
+	{
+		// previously-rendered labels used the old settings
+		std::scoped_lock lock(net->details->label_sprites_mutex);
+		net->details->label_sprites.clear();
+	}
+
 	return;
 }
 
@@ -977,6 +1165,13 @@ void Darknet::set_annotation_line_type(Darknet::NetworkPtr ptr, const cv::LineTy
 
 	net->details->cv_line_type = line_type;
 
+	if (true)
+	{
+		// previously-rendered labels used the old settings
+		std::scoped_lock lock(net->details->label_sprites_mutex);
+		net->details->label_sprites.clear();
+	}
+
 	return;
 }
 
@@ -1209,22 +1404,37 @@ void Darknet::network_dimensions(Darknet::NetworkPtr & ptr, int & w, int & h, in
 }
 
 
-Darknet::Predictions Darknet::predict(const Darknet::NetworkPtr ptr, const cv::Mat & mat)
+void Darknet::prepare_network_input(const Darknet::Network & net, const cv::Mat & mat, float * dst)
 {
 	TAT(TATPARMS);
 
-	Darknet::Network * net = reinterpret_cast<Darknet::Network *>(ptr);
-	if (net == nullptr)
+	if (mat.depth() == CV_8U and (mat.channels() == 3 or mat.channels() == 4))
 	{
-		throw std::invalid_argument("cannot predict without a network pointer");
+		// when letterboxing a stream of images of the same size into the persistent input buffer, the border written
+		// for the previous image is still valid so only the image itself needs to be written
+		bool fill_border = true;
+		if (dst == net.details->input_buffer.data() and net.details->resize_mode == Darknet::EResizeMode::LETTERBOX)
+		{
+			const cv::Size network_dimensions(net.w, net.h);
+			fill_border = (net.details->letterbox_source_size != mat.size() or net.details->letterbox_network_size != network_dimensions);
+			net.details->letterbox_source_size	= mat.size();
+			net.details->letterbox_network_size	= network_dimensions;
+		}
+
+		// resize, convert BGR to RGB, normalize, and convert to planar in a single pass
+		Darknet::bgr_mat_to_planar_rgb(mat, net.w, net.h, net.c, net.details->resize_mode, dst, fill_border);
+
+		return;
 	}
-	if (mat.empty())
+
+	// otherwise fall back to the slower method which handles unusual image formats
+
+	if (dst == net.details->input_buffer.data())
 	{
-		throw std::invalid_argument("cannot predict without a valid image");
+		net.details->letterbox_source_size = cv::Size();
 	}
 
-	const cv::Size network_dimensions(net->w, net->h);
-	const cv::Size original_image_size = mat.size();
+	const cv::Size network_dimensions(net.w, net.h);
 
 	cv::Mat bgr;
 	if (mat.size() != network_dimensions)
@@ -1259,37 +1469,55 @@ Darknet::Predictions Darknet::predict(const Darknet::NetworkPtr ptr, const cv::M
 	}
 
 	Darknet::Image img = mat_to_image(rgb);
+	const size_t size = std::min(static_cast<size_t>(img.w) * img.h * img.c, static_cast<size_t>(net.w) * net.h * net.c);
+	std::memcpy(dst, img.data, size * sizeof(float));
+	Darknet::free_image(img);
 
-	return predict(ptr, img, original_image_size);
+	return;
 }
 
 
-Darknet::Predictions Darknet::predict(Darknet::NetworkPtr ptr, Darknet::Image & img, cv::Size original_image_size)
+float * Darknet::network_input_buffer(Darknet::Network & net)
 {
 	TAT(TATPARMS);
 
-	Darknet::Network * net = reinterpret_cast<Darknet::Network *>(ptr);
-	if (net == nullptr)
+	// only grows when the network dimensions change, so this does not allocate in the usual case
+	const size_t size = static_cast<size_t>(net.w) * net.h * net.c * std::max(1, net.batch);
+	if (net.details->input_buffer.size() < size)
 	{
-		throw std::invalid_argument("cannot predict without a network pointer");
+		net.details->input_buffer.resize(size);
 	}
 
-	// If we don't know the original image size, then use the current image size.
-	// Note the bounding box results will be wrong if the image has been resized!
-	if (original_image_size.width	< 1) original_image_size.width	= img.w;
-	if (original_image_size.height	< 1) original_image_size.height	= img.h;
+	return net.details->input_buffer.data();
+}
 
-	network_predict(*net, img.data); /// todo pass net by ref or pointer, not copy constructor!
-	Darknet::free_image(img);
 
-	int nboxes = 0;
+Darknet::Detection * Darknet::get_network_detections(Darknet::Network & net, const cv::Size & original_image_size, int & nboxes)
+{
+	TAT(TATPARMS);
+
 	const float hierarchy_threshold = 0.5f;
-	auto darknet_results = get_network_boxes(net, img.w, img.h, net->details->detection_threshold, hierarchy_threshold, 0, 1, &nboxes, 0);
+	nboxes = 0;
+
+	if (net.details->resize_mode == Darknet::EResizeMode::LETTERBOX)
+	{
+		// the coordinates need to be adjusted to remove the borders, which requires the original image size
+		return get_network_boxes(&net, original_image_size.width, original_image_size.height, net.details->detection_threshold, hierarchy_threshold, 0, 1, &nboxes, 1);
+	}
+
+	// coordinates are relative, so the image size doesn't matter
+	return get_network_boxes(&net, net.w, net.h, net.details->detection_threshold, hierarchy_threshold, 0, 1, &nboxes, 0);
+}
+
+
+Darknet::Predictions Darknet::detections_to_predictions(const Darknet::Network & net, Darknet::Detection * darknet_results, const int nboxes, const cv::Size & original_image_size)
+{
+	TAT(TATPARMS);
 
-	if (net->details->non_maximal_suppression_threshold)
+	if (net.details->non_maximal_suppression_threshold)
 	{
-		auto & layer = net->layers[net->n - 1];
-		do_nms_sort(darknet_results, nboxes, layer.classes, net->details->non_maximal_suppression_threshold);
+		auto & layer = net.layers[net.n - 1];
+		do_nms_sort(darknet_results, nboxes, layer.classes, net.details->non_maximal_suppression_threshold);
 	}
 
 	Predictions predictions;
@@ -1310,7 +1538,7 @@ Darknet::Predictions Darknet::predict(Darknet::NetworkPtr ptr, Darknet::Image &
 		for (int class_idx = 0; class_idx < det.classes; class_idx ++)
 		{
 			const auto probability = det.prob[class_idx];
-			if (probability >= net->details->detection_threshold)
+			if (probability >= net.details->detection_threshold)
 			{
 				// remember this probability since it is higher than the user-specified threshold
 				pred.prob[class_idx] = probability;
@@ -1328,12 +1556,12 @@ Darknet::Predictions Darknet::predict(Darknet::NetworkPtr ptr, Darknet::Image &
 		}
 
 		// optional:  sometimes there are classes we want to completely ignore
-		if (net->details->classes_to_ignore.count(pred.best_class))
+		if (net.details->classes_to_ignore.count(pred.best_class))
 		{
 			continue;
 		}
 
-		if (net->details->fix_out_of_bound_normalized_coordinates)
+		if (net.details->fix_out_of_bound_normalized_coordinates)
 		{
 			fix_out_of_bound_normalized_rect(det.bbox.x, det.bbox.y, det.bbox.w, det.bbox.h);
 		}
@@ -1356,6 +1584,248 @@ Darknet::Predictions Darknet::predict(Darknet::NetworkPtr ptr, Darknet::Image &
 }
 
 
+Darknet::Detection * Darknet::get_network_detections_batch(Darknet::Network & net, const int batch_idx, const cv::Size & original_image_size, int & nboxes)
+{
+	TAT(TATPARMS);
+
+	const float hierarchy_threshold	= 0.5f;
+	const float threshold			= net.details->detection_threshold;
+	const int letterbox				= (net.details->resize_mode == Darknet::EResizeMode::LETTERBOX ? 1 : 0);
+
+	nboxes = 0;
+	Darknet::Detection * dets = make_network_boxes_batch(&net, threshold, &nboxes, batch_idx);
+	fill_network_boxes_batch(&net, original_image_size.width, original_image_size.height, threshold, hierarchy_threshold, nullptr, 1, dets, letterbox, batch_idx);
+
+	return dets;
+}
+
+
+std::vector<Darknet::Predictions> Darknet::predict_batch(Darknet::Network & net, const std::vector<cv::Mat> & mats)
+{
+	TAT(TATPARMS);
+
+	const int batch			= std::max(1, net.batch);
+	const size_t input_size	= static_cast<size_t>(net.w) * net.h * net.c;
+
+	std::vector<Darknet::Predictions> results;
+	results.reserve(mats.size());
+
+	for (size_t first_image = 0; first_image < mats.size(); first_image += batch)
+	{
+		const int images_in_batch = std::min<int>(batch, mats.size() - first_image);
+		float * input = network_input_buffer(net);
+		for (int idx = 0; idx < images_in_batch; idx ++)
+		{
+			prepare_network_input(net, mats[first_image + idx], input + idx * input_size);
+		}
+
+		network_predict(net, input);
+
+		for (int idx = 0; idx < images_in_batch; idx ++)
+		{
+			const cv::Size original_image_size = mats[first_image + idx].size();
+
+			int nboxes = 0;
+			Darknet::Detection * dets = get_network_detections_batch(net, idx, original_image_size, nboxes);
+			results.push_back(detections_to_predictions(net, dets, nboxes, original_image_size));
+		}
+	}
+
+	return results;
+}
+
+
+std::vector<cv::Rect> Darknet::calculate_tiles(const cv::Size & image_size, const cv::Size & tile_size, const float overlap)
+{
+	TAT(TATPARMS);
+
+	// tiles are spread evenly so the first and last tiles are aligned with the edges of the image
+	const auto positions = [overlap](const int image_length, const int tile_length) -> VInt
+	{
+		if (image_length <= tile_length)
+		{
+			return {0};
+		}
+
+		const float step = std::max(1.0f, tile_length * (1.0f - overlap));
+		const int count = 1 + static_cast<int>(std::ceil((image_length - tile_length) / step));
+
+		VInt v;
+		for (int idx = 0; idx < count; idx ++)
+		{
+			v.push_back(static_cast<int>(std::round(static_cast<float>(idx) * (image_length - tile_length) / (count - 1))));
+		}
+		return v;
+	};
+
+	const int tile_w = std::min(tile_size.width	, image_size.width);
+	const int tile_h = std::min(tile_size.height, image_size.height);
+
+	std::vector<cv::Rect> tiles;
+	for (const int y : positions(image_size.height, tile_h))
+	{
+		for (const int x : positions(image_size.width, tile_w))
+		{
+			tiles.push_back(cv::Rect(x, y, tile_w, tile_h));
+		}
+	}
+
+	return tiles;
+}
+
+
+Darknet::Predictions Darknet::predict_tiles(Darknet::Network & net, const cv::Mat & mat)
+{
+	TAT(TATPARMS);
+
+	const cv::Size tile_size = net.details->tile_size.empty() ? cv::Size(net.w, net.h) : net.details->tile_size;
+
+	std::vector<cv::Rect> tiles = calculate_tiles(mat.size(), tile_size, net.details->tile_overlap);
+	if (net.details->tile_full_frame and tiles.size() > 1)
+	{
+		// downscaled pass over the entire image to find objects which are larger than a tile
+		tiles.push_back(cv::Rect(0, 0, mat.cols, mat.rows));
+	}
+
+	const int batch					= std::max(1, net.batch);
+	const size_t input_size			= static_cast<size_t>(net.w) * net.h * net.c;
+
+	std::vector<Darknet::Detection> all_detections;
+
+	for (size_t first_tile = 0; first_tile < tiles.size(); first_tile += batch)
+	{
+		// fill as many batch slots as we can, then run the network once for all of them
+		const int tiles_in_batch = std::min<int>(batch, tiles.size() - first_tile);
+		float * input = network_input_buffer(net);
+		for (int idx = 0; idx < tiles_in_batch; idx ++)
+		{
+			prepare_network_input(net, mat(tiles[first_tile + idx]), input + idx * input_size);
+		}
+
+		network_predict(net, input);
+
+		for (int idx = 0; idx < tiles_in_batch; idx ++)
+		{
+			const cv::Rect & tile = tiles[first_tile + idx];
+
+			int nboxes = 0;
+			Darknet::Detection * dets = get_network_detections_batch(net, idx, tile.size(), nboxes);
+
+			// move the coordinates from the tile to the full image, keeping them normalized
+			for (int det_idx = 0; det_idx < nboxes; det_idx ++)
+			{
+				Darknet::Box & bbox = dets[det_idx].bbox;
+				bbox.x = (tile.x + bbox.x * tile.width	) / mat.cols;
+				bbox.y = (tile.y + bbox.y * tile.height	) / mat.rows;
+				bbox.w = bbox.w * tile.width	/ mat.cols;
+				bbox.h = bbox.h * tile.height	/ mat.rows;
+				all_detections.push_back(dets[det_idx]);
+			}
+
+			// the individual detections now belong to all_detections, so only the array is freed
+			free(dets);
+		}
+	}
+
+	// detections_to_predictions() runs NMS (which merges the duplicates along the tile seams) and frees the detections
+	const int nboxes = all_detections.size();
+	Darknet::Detection * dets = static_cast<Darknet::Detection *>(xcalloc(std::max(1, nboxes), sizeof(Darknet::Detection)));
+	std::copy(all_detections.begin(), all_detections.end(), dets);
+
+	return detections_to_predictions(net, dets, nboxes, mat.size());
+}
+
+
+Darknet::Predictions Darknet::predict(const Darknet::NetworkPtr ptr, const cv::Mat & mat)
+{
+	TAT(TATPARMS);
+
+	Darknet::Network * net = reinterpret_cast<Darknet::Network *>(ptr);
+	if (net == nullptr)
+	{
+		throw std::invalid_argument("cannot predict without a network pointer");
+	}
+	if (mat.empty())
+	{
+		throw std::invalid_argument("cannot predict without a valid image");
+	}
+
+	if (net->details->tiled_inference)
+	{
+		return predict_tiles(*net, mat);
+	}
+
+	const cv::Size original_image_size = mat.size();
+
+	// the image goes straight into the network's input buffer, so there are no image allocations
+	prepare_network_input(*net, mat, network_input_buffer(*net));
+
+	return predict_input_buffer(ptr, original_image_size);
+}
+
+
+float * Darknet::get_input_buffer(Darknet::NetworkPtr ptr)
+{
+	TAT(TATPARMS);
+
+	Darknet::Network * net = reinterpret_cast<Darknet::Network *>(ptr);
+	if (net == nullptr)
+	{
+		throw std::invalid_argument("cannot get the input buffer without a network pointer");
+	}
+
+	// the caller is about to write to the buffer, so we can no longer assume the letterbox border is intact
+	net->details->letterbox_source_size = cv::Size();
+
+	return network_input_buffer(*net);
+}
+
+
+Darknet::Predictions Darknet::predict_input_buffer(Darknet::NetworkPtr ptr, const cv::Size & original_image_size)
+{
+	TAT(TATPARMS);
+
+	Darknet::Network * net = reinterpret_cast<Darknet::Network *>(ptr);
+	if (net == nullptr)
+	{
+		throw std::invalid_argument("cannot predict without a network pointer");
+	}
+
+	network_predict(*net, network_input_buffer(*net));
+
+	int nboxes = 0;
+	auto darknet_results = get_network_detections(*net, original_image_size, nboxes);
+
+	return detections_to_predictions(*net, darknet_results, nboxes, original_image_size);
+}
+
+
+Darknet::Predictions Darknet::predict(Darknet::NetworkPtr ptr, Darknet::Image & img, cv::Size original_image_size)
+{
+	TAT(TATPARMS);
+
+	Darknet::Network * net = reinterpret_cast<Darknet::Network *>(ptr);
+	if (net == nullptr)
+	{
+		throw std::invalid_argument("cannot predict without a network pointer");
+	}
+
+	// If we don't know the original image size, then use the current image size.
+	// Note the bounding box results will be wrong if the image has been resized!
+	if (original_image_size.width	< 1) original_image_size.width	= img.w;
+	if (original_image_size.height	< 1) original_image_size.height	= img.h;
+
+	network_predict(*net, img.data); /// todo pass net by ref or pointer, not copy constructor!
+	Darknet::free_image(img);
+
+	int nboxes = 0;
+	const float hierarchy_threshold = 0.5f;
+	auto darknet_results = get_network_boxes(net, img.w, img.h, net->details->detection_threshold, hierarchy_threshold, 0, 1, &nboxes, 0);
+
+	return detections_to_predictions(*net, darknet_results, nboxes, original_image_size);
+}
+
+
 Darknet::Predictions Darknet::predict(const Darknet::NetworkPtr ptr, const std::filesystem::path & image_filename)
 {
 	TAT(TATPARMS);
@@ -1365,9 +1835,23 @@ Darknet::Predictions Darknet::predict(const Darknet::NetworkPtr ptr, const std::
 		throw std::invalid_argument("cannot predict due to invalid image filename: \"" + image_filename.string() + "\"");
 	}
 
-	cv::Mat mat = cv::imread(image_filename.string());
+	Darknet::Network * net = reinterpret_cast<Darknet::Network *>(ptr);
+	if (net == nullptr)
+	{
+		throw std::invalid_argument("cannot predict without a network pointer");
+	}
+
+	// large JPEG images are decoded at a reduced size, but the predictions are still relative to the original size
+	cv::Size original_image_size;
+	cv::Mat mat = Darknet::load_mat_image_scaled(image_filename, cv::Size(net->w, net->h), original_image_size);
+	if (mat.empty())
+	{
+		throw std::invalid_argument("failed to load image \"" + image_filename.string() + "\"");
+	}
+
+	prepare_network_input(*net, mat, network_input_buffer(*net));
 
-	return predict(ptr, mat);
+	return predict_input_buffer(ptr, original_image_size);
 }
 
 
@@ -1386,41 +1870,43 @@ cv::Mat Darknet::annotate(const Darknet::NetworkPtr ptr, const Darknet::Predicti
 		throw std::invalid_argument("cannot annotate empty image");
 	}
 
+	const cv::Rect image_rect(0, 0, mat.cols, mat.rows);
+
 	for (const auto & pred : predictions)
 	{
+		const cv::Scalar & colour = net->details->class_colours.at(pred.best_class);
+
 		if (net->details->annotate_draw_bb)
 		{
 			// draw the bounding box around the entire object
 
-			if (not net->details->bounding_boxes_with_rounded_corners)
+			if (net->details->bounding_boxes_with_rounded_corners)
 			{
-				cv::rectangle(mat, pred.rect, net->details->class_colours.at(pred.best_class), 1, net->details->cv_line_type);
+				draw_rounded_rectangle(mat, pred.rect, net->details->bounding_boxes_corner_roundness, colour, net->details->cv_line_type);
+			}
+			else if (net->details->cv_line_type == cv::LINE_AA)
+			{
+				cv::rectangle(mat, pred.rect, colour, 1, net->details->cv_line_type);
 			}
 			else
 			{
-				draw_rounded_rectangle(mat, pred.rect, net->details->bounding_boxes_corner_roundness, net->details->class_colours.at(pred.best_class), net->details->cv_line_type);
+				draw_box_outline(mat, pred.rect, colour);
 			}
 		}
 
 		if (net->details->annotate_draw_label)
 		{
-			std::string text = net->details->class_names.at(pred.best_class) + " ";
-			text += std::to_string(static_cast<int>(std::round(100.0f * pred.prob.at(pred.best_class)))) + "%";
-
-			int				font_baseline	= 0;
-			const cv::Size	size			= cv::getTextSize(text, net->details->cv_font_face, net->details->cv_font_scale, net->details->cv_font_thickness, &font_baseline);
-			cv::Rect		label			= pred.rect;
-			label.y							= label.y - size.height - font_baseline;
-			label.height					= size.height + font_baseline;
-			label.width						= size.width + 2;
-
-			// draw a rectangle above that to use as a label
-			cv::rectangle(mat, label, net->details->class_colours.at(pred.best_class), cv::FILLED, net->details->cv_line_type);
-
-			cv::mean(net->details->class_colours.at(pred.best_class));
+			// the label is rendered once per class and confidence, and then copied above the bounding box
+			const int percentage = static_cast<int>(std::round(100.0f * pred.prob.at(pred.best_class)));
+			const auto sprite = get_label_sprite(*net->details, pred.best_class, percentage, mat.type());
 
-			// and finally we draw the text on top of the label background
-			cv::putText(mat, text, cv::Point(label.x + 1, label.y + label.height - font_baseline / 2), net->details->cv_font_face, net->details->cv_font_scale, net->details->text_colours.at(pred.best_class), net->details->cv_font_thickness, net->details->cv_line_type);
+			const cv::Point tl(pred.rect.x, pred.rect.y - sprite.height);
+			const cv::Rect dst = cv::Rect(tl, sprite.image.size()) & image_rect;
+			if (dst.area() > 0)
+			{
+				const cv::Rect src = dst - tl;
+				sprite.image(src).copyTo(mat(dst), sprite.mask(src));
+			}
 		}
 	}
 
@@ -1665,6 +2151,11 @@ std::ostream & Darknet::operator<<(std::ostream & os, const Darknet::Prediction
 		<< " h=" << pred.rect.height
 		<< " entries=" << pred.prob.size();
 
+	if (pred.track_id)
+	{
+		os << " track=" << pred.track_id;
+	}
+
 	if (pred.prob.size() > 1)
 	{
 		os << " [";
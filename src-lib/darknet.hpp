@@ -65,6 +65,19 @@ namespace Darknet
 	/// The @p network structure has been renamed and moved to darknet_network.hpp.
 	struct Network;
 
+	/** How images are resized to the network dimensions prior to inference.
+	 *
+	 * @see @ref Darknet::set_resize_mode()
+	 *
+	 * @since 2026-10-18
+	 */
+	enum class EResizeMode
+	{
+		NEAREST		,	///< fastest but lowest quality, similar to @p cv::INTER_NEAREST (default)
+		BILINEAR	,	///< better quality, similar to @p cv::INTER_LINEAR
+		LETTERBOX	,	///< bilinear, but maintains the aspect ratio by adding grey borders
+	};
+
 
 	/** The likelyhood of a specific object class having been predicted.  This map contains all of the non-zero values.
 	 * The key is the zero-based class indexes, and the values are the confidences for the classes, between @p 0.0f and
@@ -245,6 +258,124 @@ namespace Darknet
 	 */
 	void set_gpu_index(int idx);
 
+	/** Set the number of worker threads used to parallelize the CPU layers.  The threads are created once and re-used
+	 * for every layer of every image, instead of being started and stopped by each loop.  This should be called before
+	 * the neural network is used, and must not be called while a network is running.
+	 *
+	 * @param [in] number_of_threads Zero means one thread per logical core less one, since the calling thread also
+	 * does work.
+	 * @param [in] pin_to_cores When @p true, each worker thread is pinned to a different core.
+	 *
+	 * @see @ref Darknet::set_thread_budget()
+	 *
+	 * @since 2026-10-18
+	 */
+	void set_worker_threads(const size_t number_of_threads, const bool pin_to_cores = false);
+
+	/** Set the maximum number of CPU threads the given network may use for each layer.  This is useful when several
+	 * networks are running side-by-side and should not compete for the same cores.
+	 *
+	 * Default is @p 0, meaning no limit.
+	 *
+	 * @see @ref Darknet::NetworkDetails::thread_budget
+	 * @see @ref Darknet::set_worker_threads()
+	 *
+	 * @since 2026-10-18
+	 */
+	void set_thread_budget(Darknet::NetworkPtr ptr, const size_t number_of_threads);
+
+	/** Run layers which do not depend on each other concurrently.  Networks such as YOLOv4 and YOLOv7 have many
+	 * parallel branches (CSP blocks, FPN/PAN paths, and multiple YOLO heads).  When enabled, the layers are scheduled
+	 * as soon as their inputs are ready instead of strictly one after the other.  This helps batch=1 latency on CPUs
+	 * with many cores, where parallelizing each layer individually stops scaling.  This has no effect when training or
+	 * when running on a GPU.
+	 *
+	 * Default is @p false.
+	 *
+	 * @see @ref Darknet::NetworkDetails::concurrent_branches
+	 * @see @ref Darknet::set_thread_budget()
+	 *
+	 * @since 2026-10-18
+	 */
+	void set_concurrent_branches(Darknet::NetworkPtr ptr, const bool toggle);
+
+	/** Determine how images are resized to the network dimensions when @ref Darknet::predict() is called with a
+	 * @p cv::Mat.  @ref Darknet::EResizeMode::LETTERBOX should be used with networks trained with @p letter_box=1.
+	 *
+	 * Default is @ref Darknet::EResizeMode::NEAREST.
+	 *
+	 * @see @ref Darknet::NetworkDetails::resize_mode
+	 *
+	 * @since 2026-10-18
+	 */
+	void set_resize_mode(Darknet::NetworkPtr ptr, const Darknet::EResizeMode mode);
+
+	/** Enable or disable tiled inference.  When enabled, @ref Darknet::predict() splits each image into overlapping
+	 * tiles.  Each tile is processed by the neural network, the bounding boxes are moved back to the coordinates of the
+	 * full image, and duplicates along the tile seams are merged with non-maximal suppression.  This finds small
+	 * objects in high resolution images which would otherwise vanish when the image is shrunk to the network size.
+	 *
+	 * @param [in] tile_size The size of each tile in pixels.  An empty size means the network dimensions.
+	 * @param [in] overlap How much adjacent tiles overlap, between @p 0.0 and @p 0.9.
+	 * @param [in] full_frame When @p true, the whole image is also processed as one additional tile to find objects
+	 * which are larger than the tiles.
+	 * @param [in] batch_size Number of tiles given to the neural network at once.  Zero leaves the network batch size
+	 * unchanged.  Changing the batch size re-allocates the network, so this should be done before processing images.
+	 *
+	 * @note Non-maximal suppression must be enabled for duplicate detections to be merged.
+	 * @see @ref Darknet::set_non_maximal_suppression_threshold()
+	 *
+	 * @since 2026-10-18
+	 */
+	void set_tiled_inference(Darknet::NetworkPtr ptr, const bool toggle, const cv::Size & tile_size = cv::Size(0, 0), const float overlap = 0.2f, const bool full_frame = true, const int batch_size = 0);
+
+	/** Get the number of NUMA nodes.  This is typically the number of CPU sockets.  Computers without NUMA will
+	 * return @p 1.
+	 *
+	 * @since 2026-10-18
+	 */
+	size_t numa_node_count();
+
+	/** Bind the neural network to a NUMA node.  This is meant for multi-socket servers, where weights allocated on one
+	 * socket and threads running on the other socket cause a lot of slow cross-socket memory traffic.
+	 *
+	 * @li The weights and layer outputs are re-allocated from the calling thread.  Since memory pages are placed on the
+	 * node of the thread which first touches them, this moves the network to the node.
+	 * @li The calling thread is restricted to the cores of that node.  Call this from the thread which will run the
+	 * network.
+	 * @li The network uses a worker pool whose threads are pinned to the cores of that node.
+	 *
+	 * To use every socket, load one copy of the network per node -- each from its own thread -- and bind each copy to
+	 * a different node.  Since the weights never change during inference, each node then has its own local replica.
+	 *
+	 * @code
+	 * std::vector<std::thread> threads;
+	 * for (size_t node = 0; node < Darknet::numa_node_count(); node ++)
+	 * {
+	 *     threads.emplace_back([=]()
+	 *     {
+	 *         auto net = Darknet::load_neural_network(cfg, names, weights);
+	 *         Darknet::bind_to_numa_node(net, node);
+	 *         // ...run inference...
+	 *     });
+	 * }
+	 * @endcode
+	 *
+	 * @see @ref Darknet::numa_throughput()
+	 *
+	 * @since 2026-10-18
+	 */
+	void bind_to_numa_node(Darknet::NetworkPtr ptr, const int node);
+
+	/** Get the number of images per second processed on each NUMA node by the given networks.  The key is the node,
+	 * or @p -1 for networks which have not been bound to a node.  The statistics are reset when a network is bound.
+	 *
+	 * @see @ref Darknet::bind_to_numa_node()
+	 *
+	 * @since 2026-10-18
+	 */
+	std::map<int, float> numa_throughput(const std::vector<Darknet::NetworkPtr> & networks);
+
 	/** Detection threshold to use when @ref Darknet::predict() is called.
 	 *
 	 * Default is @p 0.25.
@@ -382,6 +513,7 @@ namespace Darknet
 		cv::Point2f normalized_point; ///< The center point of the object.  This value is normalized and must be multiplied by the image dimensions.
 		cv::Size2f normalized_size; ///< The dimensions of the object.  This value is normalized and must be multiplied by the image dimensions.
 		cv::Rect rect; ///< The de-normalized bounding box, where the coordinates have been multiplied by the original image width and height.
+		size_t track_id = 0; ///< Identifies the same object across video frames, or @p 0 if the object is not tracked.  @see @ref Darknet::TrackedPredictor  @since 2026-10-18
 	};
 
 	/** Each image or video frame may contain many predictions.  These predictions are stored in a vector in no particular
@@ -423,6 +555,27 @@ namespace Darknet
 	 */
 	Predictions predict(const Darknet::NetworkPtr ptr, const std::filesystem::path & image_filename);
 
+	/** Get the neural network's persistent input buffer.  This contains the network width x height x channels floats,
+	 * in planar RGB order, normalized between @p 0.0 and @p 1.0.  Callers who do their own preprocessing can write
+	 * directly into this buffer and then call @ref Darknet::predict_input_buffer(), which means no image needs to be
+	 * allocated for each frame.
+	 *
+	 * The pointer remains valid until the network is resized or freed.
+	 *
+	 * @see @ref Darknet::network_dimensions()
+	 *
+	 * @since 2026-10-18
+	 */
+	float * get_input_buffer(Darknet::NetworkPtr ptr);
+
+	/** Run the neural network on the contents of the input buffer and return all predictions.
+	 *
+	 * @see @ref Darknet::get_input_buffer()
+	 *
+	 * @since 2026-10-18
+	 */
+	Predictions predict_input_buffer(Darknet::NetworkPtr ptr, const cv::Size & original_image_size);
+
 	/** Annotate the given image using the predictions from @ref Darknet::predict().
 	 *
 	 * @see @ref Darknet::predict_and_annotate()
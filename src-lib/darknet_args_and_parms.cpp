@@ -104,11 +104,13 @@ const Darknet::SArgsAndParms & Darknet::get_all_possible_arguments()
 		ArgsAndParms("detector"		, ArgsAndParms::EType::kCommand	, "Train or check neural networks."),
 		ArgsAndParms("help"			, ArgsAndParms::EType::kCommand	, "Display usage information."),
 		ArgsAndParms("imtest"		, ArgsAndParms::EType::kCommand	, ""),
+		ArgsAndParms("loadbench"	, ArgsAndParms::EType::kFunction, "Measure how fast the training images are loaded and augmented, without running the neural network."),
 		ArgsAndParms("map"			, ArgsAndParms::EType::kFunction, "Calculate mean average precision for a given dataset."),
 		ArgsAndParms("nightmare"	, ArgsAndParms::EType::kCommand	, "Run a neural network in reverse to generate strange images."),
 		ArgsAndParms("normalize"	, ArgsAndParms::EType::kCommand	, ""),
 		ArgsAndParms("oneoff"		, ArgsAndParms::EType::kCommand	, ""),
 		ArgsAndParms("ops"			, ArgsAndParms::EType::kCommand	, ""),
+		ArgsAndParms("pack"			, ArgsAndParms::EType::kFunction, "Decode all the training images once and store them in a few large files to speed up training."),
 		ArgsAndParms("partial"		, ArgsAndParms::EType::kCommand	, ""),
 		ArgsAndParms("recall"		, ArgsAndParms::EType::kFunction, ""),
 		ArgsAndParms("rescale"		, ArgsAndParms::EType::kCommand	, ""),
@@ -161,6 +163,13 @@ const Darknet::SArgsAndParms & Darknet::get_all_possible_arguments()
 		ArgsAndParms("width"				, "", 416	, "The width of the network.  --width 416"									),
 		ArgsAndParms("height"				, "", 416	, "The height of the network.  --width 416"									),
 		ArgsAndParms("skipclasses"			, "", " "	, "Class indexes which Darknet should skip when returning results or annotating images.  --skip-classes=2,5-8"),
+		ArgsAndParms("prefetch"				, "", 3		, "The number of training batches to load ahead of time.  --prefetch 3"		),
+		ArgsAndParms("seed"					, "", 0		, "The random seed used to augment training images, to reproduce the same batches.  --seed 12345"),
+		ArgsAndParms("shufflebuffer"		, "", 2000	, "When training from .tar shards, the number of images kept in memory to shuffle.  --shuffle-buffer 2000"),
+		ArgsAndParms("threads"				, "", 0		, "When measuring image loading, the number of threads to use instead of the training default.  --threads 12"),
+		ArgsAndParms("batches"				, "", 50	, "When measuring image loading, the number of batches to load.  --batches 50"),
+		ArgsAndParms("maxside"				, "", 0		, "When packing, resize images so the longest side is no more than this.  --max-side 1024"),
+		ArgsAndParms("shardsize"			, "", 4096	, "When packing, the approximate size of each file in MiB.  --shard-size 4096"),
 		ArgsAndParms("extoutput"			),
 		ArgsAndParms("savelabels"			),
 		ArgsAndParms("chart"				),
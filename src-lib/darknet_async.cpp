@@ -0,0 +1,328 @@
+#include "darknet_internal.hpp"
+#include "darknet_async.hpp"
+
+
+namespace
+{
+	static auto & cfg_and_state = Darknet::CfgAndState::get();
+}
+
+
+Darknet::AsyncPredictor::AsyncPredictor(const Darknet::NetworkPtr ptr, const size_t max_images_queued) :
+	network_ptr(ptr),
+	in_flight(0),
+	preprocess_queue(max_images_queued),
+	inference_queue(max_images_queued),
+	postprocess_queue(max_images_queued),
+	free_buffers(max_images_queued * 3 + 3)
+{
+	TAT(TATPARMS);
+
+	if (network_ptr == nullptr)
+	{
+		throw std::invalid_argument("cannot create async predictor without a network pointer");
+	}
+
+	preprocess_worker	= std::thread(&AsyncPredictor::preprocess_thread	, this);
+	inference_worker	= std::thread(&AsyncPredictor::inference_thread		, this);
+	postprocess_worker	= std::thread(&AsyncPredictor::postprocess_thread	, this);
+
+	return;
+}
+
+
+Darknet::AsyncPredictor::~AsyncPredictor()
+{
+	TAT(TATPARMS);
+
+	// shut down the pipeline one stage at a time so every job already queued is completed
+
+	preprocess_queue.close();
+	if (preprocess_worker.joinable())
+	{
+		preprocess_worker.join();
+	}
+
+	inference_queue.close();
+	if (inference_worker.joinable())
+	{
+		inference_worker.join();
+	}
+
+	postprocess_queue.close();
+	if (postprocess_worker.joinable())
+	{
+		postprocess_worker.join();
+	}
+
+	return;
+}
+
+
+std::future<Darknet::Predictions> Darknet::AsyncPredictor::predict(const cv::Mat & mat)
+{
+	TAT(TATPARMS);
+
+	if (mat.empty())
+	{
+		throw std::invalid_argument("cannot predict without a valid image");
+	}
+
+	Job job;
+	job.mat					= mat;
+	job.original_image_size	= mat.size();
+
+	auto future = job.promise.get_future();
+
+	// back-pressure:  this blocks if the preprocessing thread has fallen behind
+	in_flight ++;
+	if (not preprocess_queue.push(std::move(job)))
+	{
+		in_flight --;
+		throw std::runtime_error("cannot predict after the async predictor has been stopped");
+	}
+
+	return future;
+}
+
+
+size_t Darknet::AsyncPredictor::images_in_flight() const
+{
+	TAT(TATPARMS);
+
+	return in_flight;
+}
+
+
+void Darknet::AsyncPredictor::preprocess_thread()
+{
+	TAT(TATPARMS);
+
+	cfg_and_state.set_thread_name("async predict preprocessing");
+
+	const Darknet::Network & net = *reinterpret_cast<Darknet::Network *>(network_ptr);
+
+	Job job;
+	while (preprocess_queue.pop(job))
+	{
+		try
+		{
+			// re-use a buffer from a previous image if one is available
+			free_buffers.try_pop(job.input);
+			job.input.resize(static_cast<size_t>(net.w) * net.h * net.c);
+			Darknet::prepare_network_input(net, job.mat, job.input.data());
+		}
+		catch (...)
+		{
+			job.promise.set_exception(std::current_exception());
+			job.failed = true;
+		}
+
+		// the original image is not needed by the remaining stages
+		job.mat.release();
+
+		inference_queue.push(std::move(job));
+	}
+
+	cfg_and_state.del_thread_name();
+
+	return;
+}
+
+
+void Darknet::AsyncPredictor::inference_thread()
+{
+	TAT(TATPARMS);
+
+	cfg_and_state.set_thread_name("async predict inference");
+
+	if (cfg_and_state.gpu_index >= 0)
+	{
+		// the active GPU is a per-thread setting
+		cuda_set_device(cfg_and_state.gpu_index);
+	}
+
+	Darknet::Network * net = reinterpret_cast<Darknet::Network *>(network_ptr);
+
+	Job job;
+	while (inference_queue.pop(job))
+	{
+		if (not job.failed)
+		{
+			try
+			{
+				network_predict(*net, job.input.data());
+				job.detections = Darknet::get_network_detections(*net, job.original_image_size, job.nboxes);
+			}
+			catch (...)
+			{
+				job.promise.set_exception(std::current_exception());
+				job.failed = true;
+			}
+		}
+
+		free_buffers.try_push(std::move(job.input));
+
+		postprocess_queue.push(std::move(job));
+	}
+
+	cfg_and_state.del_thread_name();
+
+	return;
+}
+
+
+void Darknet::AsyncPredictor::postprocess_thread()
+{
+	TAT(TATPARMS);
+
+	cfg_and_state.set_thread_name("async predict post-processing");
+
+	const Darknet::Network & net = *reinterpret_cast<Darknet::Network *>(network_ptr);
+
+	Job job;
+	while (postprocess_queue.pop(job))
+	{
+		if (not job.failed)
+		{
+			try
+			{
+				job.promise.set_value(Darknet::detections_to_predictions(net, job.detections, job.nboxes, job.original_image_size));
+			}
+			catch (...)
+			{
+				job.promise.set_exception(std::current_exception());
+			}
+		}
+
+		in_flight --;
+	}
+
+	cfg_and_state.del_thread_name();
+
+	return;
+}
+
+
+size_t Darknet::annotate_video(const Darknet::NetworkPtr ptr, const std::filesystem::path & input_filename, const std::filesystem::path & output_filename)
+{
+	TAT(TATPARMS);
+
+	if (ptr == nullptr)
+	{
+		throw std::invalid_argument("cannot annotate video without a network pointer");
+	}
+
+	cv::VideoCapture cap(input_filename.string());
+	if (not cap.isOpened())
+	{
+		throw std::invalid_argument("failed to open the input video file \"" + input_filename.string() + "\"");
+	}
+
+	const double fps = cap.get(cv::CAP_PROP_FPS);
+	const cv::Size video_dimensions(cap.get(cv::CAP_PROP_FRAME_WIDTH), cap.get(cv::CAP_PROP_FRAME_HEIGHT));
+
+	cv::VideoWriter out(output_filename.string(), cv::VideoWriter::fourcc('m', 'p', '4', 'v'), fps, video_dimensions);
+	if (not out.isOpened())
+	{
+		throw std::invalid_argument("failed to open the output video file \"" + output_filename.string() + "\"");
+	}
+
+	struct Frame
+	{
+		cv::Mat mat;
+		std::future<Predictions> predictions;
+	};
+
+	const size_t queue_size = 4;
+	BoundedQueue<Frame> frames_waiting_for_annotation(queue_size);
+	BoundedQueue<cv::Mat> frames_waiting_for_output(queue_size);
+	AsyncPredictor async_predictor(ptr, queue_size);
+
+	std::exception_ptr exception;
+	std::mutex exception_mutex;
+	const auto remember_exception = [&]()
+	{
+		std::scoped_lock lock(exception_mutex);
+		if (not exception)
+		{
+			exception = std::current_exception();
+		}
+		frames_waiting_for_annotation.close();
+		frames_waiting_for_output.close();
+	};
+
+	std::thread decode_thread([&]()
+	{
+		cfg_and_state.set_thread_name("annotate video decode");
+		try
+		{
+			Frame frame;
+			while (cap.read(frame.mat) and not frame.mat.empty())
+			{
+				frame.predictions = async_predictor.predict(frame.mat);
+				if (not frames_waiting_for_annotation.push(std::move(frame)))
+				{
+					break;
+				}
+				frame.mat = cv::Mat();
+			}
+		}
+		catch (...)
+		{
+			remember_exception();
+		}
+		frames_waiting_for_annotation.close();
+		cfg_and_state.del_thread_name();
+	});
+
+	std::thread annotate_thread([&]()
+	{
+		cfg_and_state.set_thread_name("annotate video annotate");
+		try
+		{
+			Frame frame;
+			while (frames_waiting_for_annotation.pop(frame))
+			{
+				const auto predictions = frame.predictions.get();
+				Darknet::annotate(ptr, predictions, frame.mat);
+				if (not frames_waiting_for_output.push(std::move(frame.mat)))
+				{
+					break;
+				}
+			}
+		}
+		catch (...)
+		{
+			remember_exception();
+		}
+		frames_waiting_for_output.close();
+		cfg_and_state.del_thread_name();
+	});
+
+	// this thread takes care of encoding, which is typically the slowest stage
+	size_t frames_written = 0;
+	try
+	{
+		cv::Mat mat;
+		while (frames_waiting_for_output.pop(mat))
+		{
+			out.write(mat);
+			frames_written ++;
+		}
+	}
+	catch (...)
+	{
+		remember_exception();
+	}
+
+	decode_thread.join();
+	annotate_thread.join();
+
+	if (exception)
+	{
+		std::rethrow_exception(exception);
+	}
+
+	return frames_written;
+}
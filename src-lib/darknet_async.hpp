@@ -0,0 +1,144 @@
+/* Darknet/YOLO:  https://github.com/hank-ai/darknet
+ * Copyright 2024 Stephane Charette
+ */
+
+#pragma once
+
+#ifndef __cplusplus
+#error "The Darknet/YOLO project requires a C++ compiler."
+#endif
+
+/** @file
+ * This file defines @ref Darknet::AsyncPredictor, a pipelined version of @ref Darknet::predict().
+ */
+
+
+#include "darknet.hpp"
+#include "darknet_queue.hpp"
+
+#include <future>
+
+
+namespace Darknet
+{
+	/** The @p %AsyncPredictor class runs @ref Darknet::predict() as a 3-stage pipeline.  Each stage runs on a dedicated
+	 * thread:
+	 *
+	 * @li preprocessing:  resize the image to the network dimensions, convert BGR to RGB, and convert to the planar floats used by the network
+	 * @li inference:  run the neural network and retrieve the raw detections
+	 * @li post-processing:  apply NMS and convert the raw detections to @ref Darknet::Predictions
+	 *
+	 * This means preprocessing of frame @p N+1 and post-processing of frame @p N-1 take place while frame @p N is in the
+	 * neural network.  Results are returned in the same order in which the images were submitted.
+	 *
+	 * @code
+	 * Darknet::AsyncPredictor async_predictor(net);
+	 * std::deque<std::future<Darknet::Predictions>> results;
+	 * while (true)
+	 * {
+	 *     cv::Mat frame; // a new frame every time, since the previous one may still be in use
+	 *     if (not cap.read(frame))
+	 *     {
+	 *         break;
+	 *     }
+	 *     results.push_back(async_predictor.predict(frame));
+	 *     if (results.size() >= 3)
+	 *     {
+	 *         const auto predictions = results.front().get();
+	 *         results.pop_front();
+	 *         // ...
+	 *     }
+	 * }
+	 * @endcode
+	 *
+	 * @warning Only the inference thread touches the neural network, so the network pointer must not be used with
+	 * @ref Darknet::predict() or any other inference call while the @p %AsyncPredictor exists.
+	 *
+	 * @since 2026-10-18
+	 */
+	class AsyncPredictor final
+	{
+		public:
+
+			AsyncPredictor() = delete;
+			AsyncPredictor(const AsyncPredictor &) = delete;
+			AsyncPredictor & operator=(const AsyncPredictor &) = delete;
+
+			/** Constructor needs a neural network pointer.  @see @ref Darknet::load_neural_network()
+			 *
+			 * @p max_images_queued is the maximum number of images which may be waiting in front of each stage.  When
+			 * the preprocessing stage is full, @ref predict() will block until the next image has been picked up.  This
+			 * prevents the caller from queueing images faster than the neural network can process them.
+			 *
+			 * @since 2026-10-18
+			 */
+			AsyncPredictor(const Darknet::NetworkPtr ptr, const size_t max_images_queued = 4);
+
+			/// Destructor.  Images which have already been queued are processed before the threads are stopped.
+			~AsyncPredictor();
+
+			/** Queue the BGR image for processing and immediately return a future which will eventually contain the
+			 * predictions.  Any exception thrown while processing the image is re-thrown by @p std::future::get().
+			 *
+			 * @note The image is not copied, so the caller should not modify the contents of @p mat until the future
+			 * is ready.  (Reading the next video frame into a new @p cv::Mat is fine.)
+			 *
+			 * @since 2026-10-18
+			 */
+			std::future<Predictions> predict(const cv::Mat & mat);
+
+			/** Get the number of images which have been queued but for which the predictions are not yet available.
+			 *
+			 * @since 2026-10-18
+			 */
+			size_t images_in_flight() const;
+
+		private:
+
+			/// Everything we know about a single image as it moves through the pipeline.
+			struct Job
+			{
+				std::promise<Predictions>	promise;
+				cv::Mat						mat;
+				cv::Size					original_image_size;
+				VFloat						input;
+				Darknet::Detection *		detections	= nullptr;
+				int							nboxes		= 0;
+				bool						failed		= false;
+			};
+
+			void preprocess_thread();
+			void inference_thread();
+			void postprocess_thread();
+
+			const Darknet::NetworkPtr network_ptr;
+
+			std::atomic<size_t> in_flight;
+
+			BoundedQueue<Job> preprocess_queue;
+			BoundedQueue<Job> inference_queue;
+			BoundedQueue<Job> postprocess_queue;
+
+			/// Input buffers are recycled once the network is done with them, so images don't need to be allocated.
+			BoundedQueue<VFloat> free_buffers;
+
+			std::thread preprocess_worker;
+			std::thread inference_worker;
+			std::thread postprocess_worker;
+	};
+
+	/** Annotate an entire video file.  This is a complete multithreaded pipeline where every stage is connected to the
+	 * next using a @ref Darknet::BoundedQueue:
+	 *
+	 * @li decode:  read the frames from @p input_filename
+	 * @li resize and predict:  handled by an @ref Darknet::AsyncPredictor
+	 * @li annotate:  draw the predictions on each frame
+	 * @li encode:  write the annotated frames to @p output_filename
+	 *
+	 * The frame rate and dimensions of the output video are the same as the input video.  The return value is the
+	 * number of frames written.
+	 *
+	 * @since 2026-10-18
+	 */
+	size_t annotate_video(const Darknet::NetworkPtr ptr, const std::filesystem::path & input_filename, const std::filesystem::path & output_filename);
+}
@@ -1163,6 +1163,7 @@ Darknet::Network & Darknet::CfgFile::create_network(int batch, int time_steps)
 		net.workspace = (float*)xcalloc(1, parms.workspace_size);
 	}
 #endif
+	net.details->workspace_capacity = parms.workspace_size;
 
 	Darknet::ELayerType lt = net.layers[net.n - 1].type;
 	if (lt == Darknet::ELayerType::YOLO || lt == Darknet::ELayerType::REGION)
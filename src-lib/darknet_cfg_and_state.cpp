@@ -532,10 +532,14 @@ void Darknet::CfgAndState::set_thread_name(const std::thread::id & tid, const st
 {
 	TAT(TATPARMS);
 
-	if (name.empty() == false and thread_names.count(tid) == 0)
+	if (name.empty() == false)
 	{
+		// the lock must be held while looking at the map since other threads may be adding their own names
 		std::scoped_lock lock(thread_names_mutex);
-		thread_names[tid] = name;
+		if (thread_names.count(tid) == 0)
+		{
+			thread_names[tid] = name;
+		}
 	}
 
 	return;
@@ -549,9 +553,9 @@ std::string Darknet::CfgAndState::get_thread_name()
 	std::string name = "unknown thread";
 
 	const auto id = std::this_thread::get_id();
+	std::scoped_lock lock(thread_names_mutex);
 	if (thread_names.count(id) != 0)
 	{
-		std::scoped_lock lock(thread_names_mutex);
 		name = thread_names.at(id);
 	}
 
@@ -563,11 +567,8 @@ void Darknet::CfgAndState::del_thread_name(const std::thread::id & tid)
 {
 	TAT(TATPARMS);
 
-	if (thread_names.count(tid) != 0)
-	{
-		std::scoped_lock lock(thread_names_mutex);
-		thread_names.erase(tid);
-	}
+	std::scoped_lock lock(thread_names_mutex);
+	thread_names.erase(tid);
 
 	return;
 }
@@ -0,0 +1,547 @@
+#include "darknet_internal.hpp"
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <unordered_map>
+
+
+namespace
+{
+	/// Every packed file starts with these 8 bytes.
+	static const char packed_magic[8] = {'D', 'N', 'P', 'A', 'C', 'K', '\0', '\0'};
+
+	/// Increment this if the layout of the packed files changes.
+	static const uint32_t packed_version = 1;
+
+	/// Image pixels and bounding boxes start on a multiple of this many bytes.
+	static const uint64_t packed_alignment = 64;
+
+	/// Images are decoded in groups of this size when packing, so each group can be decoded in parallel.
+	static const int images_per_group = 64;
+
+	/// The header at the very start of each packed file.
+	struct ShardHeader
+	{
+		char		magic[8];
+		uint32_t	version;
+		uint32_t	records;
+		uint64_t	index_offset;
+		uint64_t	index_size;
+	};
+
+	/// Each record in the index is the length of the image filename, the filename itself, and then this structure.
+	struct IndexEntry
+	{
+		uint32_t	width;
+		uint32_t	height;
+		uint32_t	channels;
+		uint32_t	box_count;
+		uint64_t	pixel_offset;
+		uint64_t	box_offset;
+	};
+
+	/// A decoded image waiting to be written to the packed file.
+	struct DecodedImage
+	{
+		std::string						filename;
+		cv::Mat							mat;
+		std::vector<Darknet::PackedBox>	boxes;
+		std::string						error;	///< set if the image or the annotations could not be read
+	};
+
+	/// Location of an image within one of the memory-mapped files.
+	struct PackedImage
+	{
+		const uint8_t *				pixels;
+		int							width;
+		int							height;
+		int							channels;
+		const Darknet::PackedBox *	boxes;
+		int							box_count;
+	};
+
+	struct MappedFile
+	{
+		const uint8_t *	address	= nullptr;
+		size_t			size	= 0;
+		#ifdef WIN32
+		HANDLE			file	= INVALID_HANDLE_VALUE;
+		HANDLE			mapping	= nullptr;
+		#else
+		int				fd		= -1;
+		#endif
+	};
+
+	/// @{ The packed dataset opened by @ref Darknet::open_packed_dataset().  This is read-only once it has been opened.
+	static std::vector<MappedFile> mapped_files;
+	static std::unordered_map<std::string, PackedImage> packed_images;
+	/// @}
+
+
+	/// Get the name of one of the packed files.  For example, @p "cars_train.txt" becomes @p "cars_train_000.pack".
+	static inline std::filesystem::path shard_filename(const std::filesystem::path & train_filename, const size_t idx)
+	{
+		TAT(TATPARMS);
+
+		std::filesystem::path path = train_filename;
+		path.replace_extension();
+
+		std::stringstream ss;
+		ss << path.string() << "_" << std::setw(3) << std::setfill('0') << idx << ".pack";
+
+		return ss.str();
+	}
+
+
+	static inline bool map_file(const std::filesystem::path & filename, MappedFile & mf)
+	{
+		TAT(TATPARMS);
+
+		#ifdef WIN32
+		mf.file = CreateFileW(filename.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (mf.file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		LARGE_INTEGER size;
+		GetFileSizeEx(mf.file, &size);
+		mf.size = static_cast<size_t>(size.QuadPart);
+		mf.mapping = CreateFileMappingW(mf.file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mf.mapping)
+		{
+			mf.address = static_cast<const uint8_t *>(MapViewOfFile(mf.mapping, FILE_MAP_READ, 0, 0, 0));
+		}
+		#else
+		mf.fd = open(filename.string().c_str(), O_RDONLY);
+		if (mf.fd < 0)
+		{
+			return false;
+		}
+		struct stat st;
+		fstat(mf.fd, &st);
+		mf.size = static_cast<size_t>(st.st_size);
+		void * address = mmap(nullptr, mf.size, PROT_READ, MAP_SHARED, mf.fd, 0);
+		if (address != MAP_FAILED)
+		{
+			mf.address = static_cast<const uint8_t *>(address);
+			// the images are read in random order during training
+			madvise(address, mf.size, MADV_RANDOM);
+		}
+		#endif
+
+		return mf.address != nullptr;
+	}
+
+
+	static inline void unmap_file(MappedFile & mf)
+	{
+		TAT(TATPARMS);
+
+		#ifdef WIN32
+		if (mf.address)							UnmapViewOfFile(mf.address);
+		if (mf.mapping)							CloseHandle(mf.mapping);
+		if (mf.file != INVALID_HANDLE_VALUE)	CloseHandle(mf.file);
+		#else
+		if (mf.address)							munmap(const_cast<uint8_t *>(mf.address), mf.size);
+		if (mf.fd >= 0)							close(mf.fd);
+		#endif
+
+		mf = MappedFile();
+
+		return;
+	}
+
+
+	/** Decode the image and read the annotations, which is exactly the work that packing saves us from doing while
+	 * training.  This runs on the worker threads, so problems are returned in @ref DecodedImage::error instead of
+	 * calling @ref darknet_fatal_error().
+	 */
+	static inline DecodedImage decode_image(const std::string & filename, const int max_side)
+	{
+		TAT(TATPARMS);
+
+		DecodedImage decoded;
+		decoded.filename = filename;
+
+		decoded.mat = cv::imread(filename, cv::IMREAD_COLOR);
+		if (decoded.mat.empty())
+		{
+			decoded.error = "failed to load image file \"" + filename + "\"";
+			return decoded;
+		}
+		cv::cvtColor(decoded.mat, decoded.mat, cv::COLOR_BGR2RGB);
+
+		const int longest_side = std::max(decoded.mat.cols, decoded.mat.rows);
+		if (max_side > 0 and longest_side > max_side)
+		{
+			// the annotations are normalized, so they don't change when the image is resized
+			const double factor = static_cast<double>(max_side) / longest_side;
+			cv::Mat resized;
+			cv::resize(decoded.mat, resized, cv::Size(), factor, factor, cv::INTER_AREA);
+			decoded.mat = resized;
+		}
+
+		char labelpath[4096];
+		replace_image_to_label(filename.c_str(), labelpath);
+		if (not std::filesystem::exists(labelpath))
+		{
+			// read_boxes() would call darknet_fatal_error()
+			decoded.error = "failed to open annotation file \"" + std::string(labelpath) + "\"";
+			return decoded;
+		}
+
+		int count = 0;
+		box_label * boxes = read_boxes(labelpath, &count);
+		decoded.boxes.reserve(count);
+		for (int idx = 0; idx < count; idx ++)
+		{
+			decoded.boxes.push_back({boxes[idx].id, boxes[idx].x, boxes[idx].y, boxes[idx].w, boxes[idx].h});
+		}
+		free(boxes);
+
+		return decoded;
+	}
+
+
+	/// Write the index and the header, which completes one of the packed files.
+	static inline void finish_shard(std::ofstream & ofs, const std::string & index, const uint32_t records)
+	{
+		TAT(TATPARMS);
+
+		ShardHeader header;
+		std::memcpy(header.magic, packed_magic, sizeof(header.magic));
+		header.version		= packed_version;
+		header.records		= records;
+		header.index_offset	= ofs.tellp();
+		header.index_size	= index.size();
+
+		ofs.write(index.data(), index.size());
+		ofs.seekp(0);
+		ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		ofs.close();
+
+		return;
+	}
+}
+
+
+void Darknet::pack_dataset(const std::filesystem::path & data_filename, const int max_side, const size_t shard_size_mib)
+{
+	TAT(TATPARMS);
+
+	list * options = read_data_cfg(data_filename.string().c_str());
+	const std::filesystem::path train_filename = option_find_str(options, "train", "data/train.txt");
+
+	list * plist = get_paths(train_filename.string().c_str());
+	char ** paths = (char **)list_to_array(plist);
+	const int number_of_images = plist->size;
+	if (number_of_images == 0)
+	{
+		darknet_fatal_error(DARKNET_LOC, "no training images available (verify %s)", train_filename.string().c_str());
+	}
+
+	// remove the files from a previous run, since there may have been more of them
+	for (size_t idx = 0; std::filesystem::exists(shard_filename(train_filename, idx)); idx ++)
+	{
+		std::filesystem::remove(shard_filename(train_filename, idx));
+	}
+
+	const uint64_t maximum_shard_size = std::max<size_t>(1, shard_size_mib) * 1024 * 1024;
+
+	std::cout
+		<< "Packing " << number_of_images << " images from " << train_filename.string()
+		<< (max_side > 0 ? " (longest side limited to " + std::to_string(max_side) + " pixels)" : "")
+		<< "." << std::endl;
+
+	size_t shard_idx		= 0;
+	uint32_t records		= 0;
+	uint64_t total_bytes	= 0;
+	std::ofstream ofs;
+	std::string index;
+
+	for (int first = 0; first < number_of_images; first += images_per_group)
+	{
+		const int last = std::min(number_of_images, first + images_per_group);
+		std::vector<DecodedImage> group(last - first);
+
+		Darknet::parallel_for(first, last, [&](const int idx)
+		{
+			try
+			{
+				group[idx - first] = decode_image(paths[idx], max_side);
+			}
+			catch (const std::exception & e)
+			{
+				group[idx - first].filename	= paths[idx];
+				group[idx - first].error	= "failed to pack \"" + std::string(paths[idx]) + "\": " + e.what();
+			}
+		});
+
+		// now that we're back on the main thread it is safe to abort
+		for (const auto & decoded : group)
+		{
+			if (not decoded.error.empty())
+			{
+				darknet_fatal_error(DARKNET_LOC, "%s", decoded.error.c_str());
+			}
+		}
+
+		for (const auto & decoded : group)
+		{
+			const uint64_t pixel_bytes	= decoded.mat.total() * decoded.mat.elemSize();
+			const uint64_t box_bytes	= decoded.boxes.size() * sizeof(PackedBox);
+
+			if (ofs.is_open() and records > 0 and static_cast<uint64_t>(ofs.tellp()) + 2 * packed_alignment + pixel_bytes + box_bytes + index.size() > maximum_shard_size)
+			{
+				finish_shard(ofs, index, records);
+				shard_idx ++;
+			}
+
+			if (not ofs.is_open())
+			{
+				const auto filename = shard_filename(train_filename, shard_idx);
+				ofs.open(filename, std::ios::binary | std::ios::trunc);
+				if (not ofs.good())
+				{
+					darknet_fatal_error(DARKNET_LOC, "failed to create \"%s\"", filename.string().c_str());
+				}
+
+				// the header is written once again when the file is complete
+				const ShardHeader header = {};
+				ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+				records = 0;
+				index.clear();
+			}
+
+			// pad so the bounding boxes and the pixels are both aligned
+			const auto align = [&]()
+			{
+				const uint64_t position = ofs.tellp();
+				const uint64_t padding = (packed_alignment - position % packed_alignment) % packed_alignment;
+				const char zeros[packed_alignment] = {0};
+				ofs.write(zeros, padding);
+				total_bytes += padding;
+				return position + padding;
+			};
+
+			IndexEntry entry;
+			entry.width			= decoded.mat.cols;
+			entry.height		= decoded.mat.rows;
+			entry.channels		= decoded.mat.channels();
+			entry.box_count		= decoded.boxes.size();
+
+			entry.box_offset = align();
+			ofs.write(reinterpret_cast<const char *>(decoded.boxes.data()), box_bytes);
+
+			entry.pixel_offset = align();
+			const cv::Mat mat = decoded.mat.isContinuous() ? decoded.mat : decoded.mat.clone();
+			ofs.write(reinterpret_cast<const char *>(mat.data), pixel_bytes);
+
+			const uint32_t length = decoded.filename.size();
+			index.append(reinterpret_cast<const char *>(&length), sizeof(length));
+			index.append(decoded.filename);
+			index.append(reinterpret_cast<const char *>(&entry), sizeof(entry));
+
+			records ++;
+			total_bytes += pixel_bytes + box_bytes;
+		}
+
+		if (last % 1000 < images_per_group or last == number_of_images)
+		{
+			std::cout << "\r-> " << last << "/" << number_of_images << " images packed" << std::flush;
+		}
+	}
+
+	if (ofs.is_open())
+	{
+		finish_shard(ofs, index, records);
+	}
+
+	std::cout
+		<< std::endl
+		<< "-> created " << (shard_idx + 1) << " file" << (shard_idx == 0 ? "" : "s")
+		<< " with " << size_to_IEC_string(total_bytes) << " of images"
+		<< ", starting with " << shard_filename(train_filename, 0).string() << std::endl;
+
+	free(paths);
+	free_list_contents(plist);
+	free_list(plist);
+	free_list_contents_kvp(options);
+	free_list(options);
+
+	return;
+}
+
+
+bool Darknet::open_packed_dataset(const std::filesystem::path & train_filename)
+{
+	TAT(TATPARMS);
+
+	close_packed_dataset();
+
+	const auto first_shard = shard_filename(train_filename, 0);
+	if (not std::filesystem::exists(first_shard))
+	{
+		return false;
+	}
+
+	if (std::filesystem::last_write_time(first_shard) < std::filesystem::last_write_time(train_filename))
+	{
+		Darknet::display_warning_msg("Ignoring the packed dataset " + first_shard.string() + " since " + train_filename.string() + " is newer.  Run \"darknet detector pack\" again.\n");
+		return false;
+	}
+
+	for (size_t idx = 0; std::filesystem::exists(shard_filename(train_filename, idx)); idx ++)
+	{
+		const auto filename = shard_filename(train_filename, idx);
+
+		MappedFile mf;
+		if (not map_file(filename, mf))
+		{
+			unmap_file(mf);
+			close_packed_dataset();
+			Darknet::display_warning_msg("Failed to map " + filename.string() + ".  The packed dataset will not be used.\n");
+			return false;
+		}
+		mapped_files.push_back(mf);
+
+		ShardHeader header = {};
+		std::memcpy(&header, mf.address, std::min(sizeof(header), mf.size));
+		bool valid =
+			mf.size >= sizeof(header)									and
+			std::memcmp(header.magic, packed_magic, sizeof(header.magic)) == 0	and
+			header.version == packed_version							and
+			header.index_offset <= mf.size								and
+			header.index_size <= mf.size - header.index_offset;
+
+		// every record is checked against the size of the file, so a damaged or edited file cannot make us read past the mapping
+		const uint8_t * ptr = mf.address + (valid ? header.index_offset : 0);
+		const uint8_t * end = ptr + (valid ? header.index_size : 0);
+		for (uint32_t record = 0; valid and record < header.records; record ++)
+		{
+			uint32_t length = 0;
+			if (static_cast<size_t>(end - ptr) < sizeof(length))
+			{
+				valid = false;
+				break;
+			}
+			std::memcpy(&length, ptr, sizeof(length));
+			ptr += sizeof(length);
+			if (static_cast<size_t>(end - ptr) < length + sizeof(IndexEntry))
+			{
+				valid = false;
+				break;
+			}
+			const std::string image_filename(reinterpret_cast<const char *>(ptr), length);
+			ptr += length;
+			IndexEntry entry;
+			std::memcpy(&entry, ptr, sizeof(entry));
+			ptr += sizeof(entry);
+
+			const uint64_t pixels = static_cast<uint64_t>(entry.width) * entry.height;
+			if (entry.width == 0 or entry.height == 0 or entry.width > INT_MAX or entry.height > INT_MAX	or
+				entry.channels < 1 or entry.channels > 4												or
+				entry.pixel_offset > mf.size or pixels > (mf.size - entry.pixel_offset) / entry.channels	or
+				entry.box_offset > mf.size or entry.box_offset % alignof(PackedBox) != 0					or
+				entry.box_count > (mf.size - entry.box_offset) / sizeof(PackedBox))
+			{
+				valid = false;
+				break;
+			}
+
+			PackedImage & pi = packed_images[image_filename];
+			pi.pixels		= mf.address + entry.pixel_offset;
+			pi.width		= entry.width;
+			pi.height		= entry.height;
+			pi.channels		= entry.channels;
+			pi.boxes		= reinterpret_cast<const PackedBox *>(mf.address + entry.box_offset);
+			pi.box_count	= entry.box_count;
+		}
+
+		if (not valid)
+		{
+			close_packed_dataset();
+			Darknet::display_warning_msg("The packed file " + filename.string() + " is invalid or incomplete.  The packed dataset will not be used.\n");
+			return false;
+		}
+	}
+
+	std::cout << "Using the packed dataset " << first_shard.string() << " (" << mapped_files.size() << " file" << (mapped_files.size() == 1 ? "" : "s") << ", " << packed_images.size() << " images)." << std::endl;
+
+	return true;
+}
+
+
+void Darknet::close_packed_dataset()
+{
+	TAT(TATPARMS);
+
+	packed_images.clear();
+	for (auto & mf : mapped_files)
+	{
+		unmap_file(mf);
+	}
+	mapped_files.clear();
+
+	return;
+}
+
+
+cv::Mat Darknet::get_packed_image(const char * filename, const int channels)
+{
+	TAT(TATPARMS);
+
+	if (packed_images.empty())
+	{
+		return cv::Mat();
+	}
+
+	const auto iter = packed_images.find(filename);
+	if (iter == packed_images.end())
+	{
+		return cv::Mat();
+	}
+
+	const auto & pi = iter->second;
+	cv::Mat mat(pi.height, pi.width, CV_8UC(pi.channels), const_cast<uint8_t *>(pi.pixels));
+
+	if (channels == 1 and pi.channels == 3)
+	{
+		cv::Mat grey;
+		cv::cvtColor(mat, grey, cv::COLOR_RGB2GRAY);
+		return grey;
+	}
+
+	return mat;
+}
+
+
+const Darknet::PackedBox * Darknet::get_packed_boxes(const char * filename, int & count)
+{
+	TAT(TATPARMS);
+
+	count = 0;
+
+	if (packed_images.empty())
+	{
+		return nullptr;
+	}
+
+	const auto iter = packed_images.find(filename);
+	if (iter == packed_images.end())
+	{
+		return nullptr;
+	}
+
+	count = iter->second.box_count;
+
+	return iter->second.boxes;
+}
@@ -0,0 +1,72 @@
+/* Darknet/YOLO:  https://github.com/hank-ai/darknet
+ * Copyright 2024 Stephane Charette
+ */
+
+#pragma once
+
+#include "darknet_internal.hpp"
+
+/** @file
+ * Packed training datasets.  The images listed in @p train=... are decoded once by @p "darknet detector pack" and stored
+ * as raw pixels next to their bounding boxes in a few large files.  During training these files are memory-mapped, so
+ * the image loading threads no longer need to decode JPEG or PNG images, nor parse the annotation files.
+ *
+ * @see @ref Darknet::pack_dataset()
+ * @see @ref Darknet::open_packed_dataset()
+ */
+
+
+namespace Darknet
+{
+	/** A single bounding box as stored in a packed dataset.  The coordinates are normalized, exactly as they appear in
+	 * the annotation @p .txt files.
+	 *
+	 * @since 2026-10-18
+	 */
+	struct PackedBox
+	{
+		int32_t	id;
+		float	x;
+		float	y;
+		float	w;
+		float	h;
+	};
+
+	/** Create the packed dataset for the training images referenced in the given @p .data file.  This is the
+	 * implementation of the @p "darknet detector pack" command.  Images are stored as RGB, and are optionally resized
+	 * so the longest side is no more than @p max_side pixels.  Each file ("shard") is limited to approximately
+	 * @p shard_size_mib MiB.
+	 *
+	 * @since 2026-10-18
+	 */
+	void pack_dataset(const std::filesystem::path & data_filename, const int max_side, const size_t shard_size_mib);
+
+	/** Memory-map the packed dataset created for this list of training images, if there is one.  Returns @p false if
+	 * no packed dataset exists, if it is older than the list of images, or if any of the files are damaged.
+	 *
+	 * @note Only the timestamp of the list of images is compared.  Individual images or annotations which were modified
+	 * after the dataset was packed are not detected, and the old pixels and bounding boxes continue to be used until
+	 * @p "darknet detector pack" is run again.
+	 *
+	 * @since 2026-10-18
+	 */
+	bool open_packed_dataset(const std::filesystem::path & train_filename);
+
+	/// Release the memory-mapped files opened by @ref open_packed_dataset().  @since 2026-10-18
+	void close_packed_dataset();
+
+	/** Get the image from the packed dataset.  The returned image is RGB (or greyscale when @p channels is @p 1).  When
+	 * possible the image points directly into the memory-mapped file, so it must @em not be modified.  Returns an empty
+	 * image if no packed dataset is open, or if the image was not packed.
+	 *
+	 * @since 2026-10-18
+	 */
+	cv::Mat get_packed_image(const char * filename, const int channels);
+
+	/** Get the bounding boxes for this image from the packed dataset.  Returns @p nullptr if no packed dataset is open,
+	 * or if the image was not packed.
+	 *
+	 * @since 2026-10-18
+	 */
+	const PackedBox * get_packed_boxes(const char * filename, int & count);
+}
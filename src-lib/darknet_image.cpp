@@ -53,6 +53,331 @@ namespace
 
 		return (a < b) ? ( (a < c) ? a : c) : ( (b < c) ? b : c) ;
 	}
+
+
+	/** Interpolation weights for one direction of @ref Darknet::resize_image().  For each destination pixel we have the
+	 * 2 source pixels and their weights.  The edge cases are folded into the tables so the inner loops have no branches.
+	 */
+	struct ResizeAxis
+	{
+		Darknet::VInt	idx0;
+		Darknet::VInt	idx1;
+		Darknet::VFloat	weight0;
+		Darknet::VFloat	weight1;
+	};
+
+
+	struct ResizeCoefficients
+	{
+		ResizeAxis horizontal;
+		ResizeAxis vertical;
+	};
+
+
+	/** The corners are aligned, meaning the first and last pixels of the source and destination are at the same place.
+	 *
+	 * @note This is not identical to the original @p resize_image().  The last row and column always copy the last
+	 * source pixel.  The original code did this for the last column, but for the last row it used @p (1-dy) times the
+	 * source row, and rounding could make @p dy close to @p 1.  That left the bottom row much too dark.  A destination
+	 * which is 1 pixel high also no longer divides by zero.
+	 */
+	static inline ResizeAxis calculate_resize_axis(const int src, const int dst)
+	{
+		TAT(TATPARMS);
+
+		ResizeAxis axis;
+		axis.idx0		.resize(dst);
+		axis.idx1		.resize(dst);
+		axis.weight0	.resize(dst);
+		axis.weight1	.resize(dst);
+
+		const float scale = (dst > 1 ? (src - 1.0f) / (dst - 1.0f) : 0.0f);
+
+		for (int i = 0; i < dst; i ++)
+		{
+			const float pos		= i * scale;
+			const int idx		= std::min(static_cast<int>(pos), src - 1);
+			const float delta	= pos - idx;
+
+			if (i == dst - 1 or src == 1)
+			{
+				// the last pixel is copied as-is, since there is no next pixel to blend with
+				axis.idx0	[i] = src - 1;
+				axis.idx1	[i] = src - 1;
+				axis.weight0[i] = 1.0f;
+				axis.weight1[i] = 0.0f;
+			}
+			else
+			{
+				axis.idx0	[i] = idx;
+				axis.idx1	[i] = idx + 1;
+				axis.weight0[i] = 1.0f - delta;
+				axis.weight1[i] = delta;
+			}
+		}
+
+		return axis;
+	}
+
+
+	/** Calculating the coefficients is not free, and the same few sizes are used over and over again (video frames,
+	 * training images, etc.) so the tables are kept per thread, keyed on the source and destination dimensions.
+	 */
+	static inline const ResizeCoefficients & get_resize_coefficients(const int src_w, const int src_h, const int dst_w, const int dst_h)
+	{
+		TAT(TATPARMS);
+
+		static thread_local std::map<std::tuple<int, int, int, int>, ResizeCoefficients> cache;
+
+		const auto key = std::make_tuple(src_w, src_h, dst_w, dst_h);
+		auto iter = cache.find(key);
+		if (iter == cache.end())
+		{
+			if (cache.size() >= 32)
+			{
+				// we're seeing lots of different sizes, so forget about the old ones
+				cache.clear();
+			}
+
+			ResizeCoefficients coefficients;
+			coefficients.horizontal	= calculate_resize_axis(src_w, dst_w);
+			coefficients.vertical	= calculate_resize_axis(src_h, dst_h);
+			iter = cache.emplace(key, std::move(coefficients)).first;
+		}
+
+		return iter->second;
+	}
+
+
+	/// Horizontal pass for a single row.
+	static inline void resize_row(const float * src, float * dst, const ResizeAxis & axis)
+	{
+		const int * idx0		= axis.idx0.data();
+		const int * idx1		= axis.idx1.data();
+		const float * weight0	= axis.weight0.data();
+		const float * weight1	= axis.weight1.data();
+		const int w				= static_cast<int>(axis.idx0.size());
+
+		for (int x = 0; x < w; x ++)
+		{
+			dst[x] = weight0[x] * src[idx0[x]] + weight1[x] * src[idx1[x]];
+		}
+
+		return;
+	}
+
+
+	/** Resize @p im into the rectangle at @p x_offset, @p y_offset of size @p w x @p h within the destination image
+	 * @p dst which is @p dst_w x @p dst_h.  The rest of the destination is not modified.
+	 */
+	static inline void resize_image_region(const Darknet::Image & im, float * dst, const int dst_w, const int dst_h, const int x_offset, const int y_offset, const int w, const int h)
+	{
+		TAT(TATPARMS);
+
+		const auto & coefficients = get_resize_coefficients(im.w, im.h, w, h);
+		const auto & vertical = coefficients.vertical;
+
+		/* Each output row is a blend of 2 source rows which have been resized horizontally.  Rather than resizing every
+		 * source row into an intermediate image, we resize the 2 rows we need as we go.  When enlarging an image, the
+		 * same source rows are used by consecutive output rows so we keep track of which ones are already available.
+		 */
+		auto & pool = Darknet::WorkerPool::current();
+		pool.parallel_for(0, h * im.c, [&](const int chunk_begin, const int chunk_end)
+		{
+			static thread_local Darknet::VFloat scratch;
+			if (scratch.size() < 2 * static_cast<size_t>(w))
+			{
+				scratch.resize(2 * static_cast<size_t>(w));
+			}
+			float * row0 = scratch.data();
+			float * row1 = scratch.data() + w;
+			int row0_idx = -1;
+			int row1_idx = -1;
+			int row_channel = -1;
+
+			for (int idx = chunk_begin; idx < chunk_end; idx ++)
+			{
+				const int k = idx / h;
+				const int y = idx % h;
+				const float * src = im.data + static_cast<size_t>(k) * im.w * im.h;
+
+				if (k != row_channel)
+				{
+					row_channel	= k;
+					row0_idx	= -1;
+					row1_idx	= -1;
+				}
+
+				const int y0 = vertical.idx0[y];
+				const int y1 = vertical.idx1[y];
+				if (row0_idx != y0)
+				{
+					if (row1_idx == y0)
+					{
+						// moving down by 1 row, so the bottom row becomes the top row
+						std::swap(row0, row1);
+						std::swap(row0_idx, row1_idx);
+					}
+					else
+					{
+						resize_row(src + static_cast<size_t>(y0) * im.w, row0, coefficients.horizontal);
+						row0_idx = y0;
+					}
+				}
+				if (row1_idx != y1 and y1 != y0)
+				{
+					resize_row(src + static_cast<size_t>(y1) * im.w, row1, coefficients.horizontal);
+					row1_idx = y1;
+				}
+
+				float * out = dst + (static_cast<size_t>(k) * dst_h + y_offset + y) * dst_w + x_offset;
+				const float weight0 = vertical.weight0[y];
+				const float weight1 = vertical.weight1[y];
+				if (y1 == y0)
+				{
+					for (int x = 0; x < w; x ++)
+					{
+						out[x] = weight0 * row0[x];
+					}
+				}
+				else
+				{
+					for (int x = 0; x < w; x ++)
+					{
+						out[x] = weight0 * row0[x] + weight1 * row1[x];
+					}
+				}
+			}
+		}, 4, Darknet::WorkerPool::current_budget());
+
+		return;
+	}
+
+	/** Set the area around the rectangle at @p x_offset, @p y_offset of size @p w x @p h to the given value.  This is
+	 * the grey border added when letterboxing.  The inside of the rectangle is not modified.
+	 */
+	static inline void fill_letterbox_border(float * dst, const int dst_w, const int dst_h, const int channels, const int x_offset, const int y_offset, const int w, const int h, const float value)
+	{
+		TAT(TATPARMS);
+
+		for (int k = 0; k < channels; k ++)
+		{
+			float * plane = dst + static_cast<size_t>(k) * dst_w * dst_h;
+
+			// top and bottom borders are contiguous rows
+			std::fill(plane, plane + static_cast<size_t>(y_offset) * dst_w, value);
+			std::fill(plane + static_cast<size_t>(y_offset + h) * dst_w, plane + static_cast<size_t>(dst_w) * dst_h, value);
+
+			// left and right borders
+			if (w < dst_w)
+			{
+				for (int y = y_offset; y < y_offset + h; y ++)
+				{
+					float * row = plane + static_cast<size_t>(y) * dst_w;
+					std::fill(row, row + x_offset, value);
+					std::fill(row + x_offset + w, row + dst_w, value);
+				}
+			}
+		}
+
+		return;
+	}
+
+
+	/// Calculate where the image goes when letterboxing.  This must match @ref correct_yolo_boxes().
+	static inline cv::Rect letterbox_region(const int src_w, const int src_h, const int w, const int h)
+	{
+		TAT(TATPARMS);
+
+		int new_w = w;
+		int new_h = h;
+		if (static_cast<float>(w) / src_w < static_cast<float>(h) / src_h)
+		{
+			new_h = (src_h * w) / src_w;
+		}
+		else
+		{
+			new_w = (src_w * h) / src_h;
+		}
+
+		return cv::Rect((w - new_w) / 2, (h - new_h) / 2, new_w, new_h);
+	}
+
+
+	/** Read the dimensions of a JPEG image from the @p SOF marker without decoding the image.  Returns an empty size if
+	 * the file is not a JPEG image or the header cannot be parsed.  EXIF orientation is not taken into account.
+	 */
+	static inline cv::Size read_jpeg_dimensions(const std::filesystem::path & filename)
+	{
+		TAT(TATPARMS);
+
+		std::ifstream ifs(filename, std::ios::binary);
+
+		const auto read_byte = [&ifs]() -> int
+		{
+			const int c = ifs.get();
+			return ifs.good() ? c : -1;
+		};
+		const auto read_word = [&read_byte]() -> int
+		{
+			const int hi = read_byte();
+			const int lo = read_byte();
+			return (hi < 0 or lo < 0) ? -1 : (hi << 8) | lo;
+		};
+
+		if (read_byte() != 0xFF or read_byte() != 0xD8)
+		{
+			// not a JPEG file
+			return cv::Size();
+		}
+
+		while (ifs.good())
+		{
+			int marker = read_byte();
+			if (marker != 0xFF)
+			{
+				break;
+			}
+			// markers may be preceded by any number of 0xFF fill bytes
+			while (marker == 0xFF)
+			{
+				marker = read_byte();
+			}
+			if (marker < 0 or marker == 0xD9 or marker == 0xDA)
+			{
+				// end of image or start of scan without having found the frame header
+				break;
+			}
+			if (marker == 0x01 or (marker >= 0xD0 and marker <= 0xD7))
+			{
+				// standalone markers have no length
+				continue;
+			}
+
+			const int length = read_word();
+			if (length < 2)
+			{
+				break;
+			}
+
+			// SOF0 to SOF15, except DHT (C4), JPG (C8), and DAC (CC) which share the same range
+			if (marker >= 0xC0 and marker <= 0xCF and marker != 0xC4 and marker != 0xC8 and marker != 0xCC)
+			{
+				read_byte(); // sample precision
+				const int height	= read_word();
+				const int width		= read_word();
+				if (width > 0 and height > 0)
+				{
+					return cv::Size(width, height);
+				}
+				break;
+			}
+
+			ifs.seekg(length - 2, std::ios::cur);
+		}
+
+		return cv::Size();
+	}
 }
 
 
@@ -868,6 +1193,128 @@ Darknet::Image Darknet::bgr_mat_to_rgb_image(const cv::Mat & mat)
 }
 
 
+void Darknet::bgr_mat_to_planar_rgb(const cv::Mat & mat, const int w, const int h, const int c, const Darknet::EResizeMode mode, float * dst, const bool fill_border)
+{
+	TAT(TATPARMS);
+
+	if (mat.empty() or mat.depth() != CV_8U or (mat.channels() != 3 and mat.channels() != 4))
+	{
+		throw std::invalid_argument("expected an 8-bit BGR or BGRA image");
+	}
+	if (w < 1 or h < 1 or c < 1 or dst == nullptr)
+	{
+		throw std::invalid_argument("invalid destination for the network input");
+	}
+
+	// never write more planes than the destination has room for -- a greyscale network only gets the red plane
+	const int planes	= std::min(c, 3);
+	const int channels	= mat.channels();
+	const size_t plane	= static_cast<size_t>(w) * h;
+
+	// the area of the destination where the image goes (only smaller than the destination when letterboxing)
+	int new_w	= w;
+	int new_h	= h;
+	int dx		= 0;
+	int dy		= 0;
+	if (mode == Darknet::EResizeMode::LETTERBOX)
+	{
+		// same calculation as letterbox_image() and correct_yolo_boxes() so the coordinates line up
+		const cv::Rect region = letterbox_region(mat.cols, mat.rows, w, h);
+		new_w	= region.width;
+		new_h	= region.height;
+		dx		= region.x;
+		dy		= region.y;
+
+		// only the border is written here, the rest of the destination is about to be overwritten by the image
+		if (fill_border)
+		{
+			fill_letterbox_border(dst, w, h, planes, dx, dy, new_w, new_h, 0.5f);
+		}
+	}
+
+	const float scale_x = static_cast<float>(mat.cols) / new_w;
+	const float scale_y = static_cast<float>(mat.rows) / new_h;
+	constexpr float normalize = 1.0f / 255.0f;
+
+	/* The inner loops below are plain scalar code.  Each one writes a single plane with a fixed source channel so the
+	 * compiler can auto-vectorize the arithmetic, but there are no hand-written SIMD intrinsics.
+	 */
+
+	if (mode == Darknet::EResizeMode::NEAREST)
+	{
+		// byte offset of the source pixel for each destination column, so the inner loop doesn't need to do any math
+		std::vector<int> x_offset(new_w);
+		for (int x = 0; x < new_w; x ++)
+		{
+			x_offset[x] = std::min(static_cast<int>(x * scale_x), mat.cols - 1) * channels;
+		}
+
+		Darknet::parallel_for(0, new_h, [&](const int y)
+		{
+			const int src_y = std::min(static_cast<int>(y * scale_y), mat.rows - 1);
+			const size_t idx = static_cast<size_t>(y + dy) * w + dx;
+
+			for (int k = 0; k < planes; k ++)
+			{
+				// plane "k" is R, G, B, while OpenCV stores B, G, R
+				const uint8_t * src = mat.ptr<uint8_t>(src_y) + (2 - k);
+				float * out = dst + plane * k + idx;
+
+				for (int x = 0; x < new_w; x ++)
+				{
+					out[x] = src[x_offset[x]] * normalize;
+				}
+			}
+		}, 8);
+	}
+	else
+	{
+		// bilinear sampling, using the same pixel centre convention as cv::INTER_LINEAR
+		std::vector<int> x0(new_w);
+		std::vector<int> x1(new_w);
+		std::vector<float> fx(new_w);
+		for (int x = 0; x < new_w; x ++)
+		{
+			const float src_x = std::clamp((x + 0.5f) * scale_x - 0.5f, 0.0f, static_cast<float>(mat.cols - 1));
+			const int left = static_cast<int>(src_x);
+			x0[x] = left * channels;
+			x1[x] = std::min(left + 1, mat.cols - 1) * channels;
+			fx[x] = src_x - left;
+		}
+
+		Darknet::parallel_for(0, new_h, [&](const int y)
+		{
+			const float src_y	= std::clamp((y + 0.5f) * scale_y - 0.5f, 0.0f, static_cast<float>(mat.rows - 1));
+			const int top		= static_cast<int>(src_y);
+			const float fy		= src_y - top;
+			const float wy0		= (1.0f - fy) * normalize;
+			const float wy1		= fy * normalize;
+			const size_t idx	= static_cast<size_t>(y + dy) * w + dx;
+
+			for (int k = 0; k < planes; k ++)
+			{
+				// plane "k" is R, G, B, while OpenCV stores B, G, R
+				const uint8_t * row0 = mat.ptr<uint8_t>(top) + (2 - k);
+				const uint8_t * row1 = mat.ptr<uint8_t>(std::min(top + 1, mat.rows - 1)) + (2 - k);
+				float * out = dst + plane * k + idx;
+
+				for (int x = 0; x < new_w; x ++)
+				{
+					const float wx1 = fx[x];
+					const float wx0 = 1.0f - wx1;
+
+					out[x] =
+						(row0[x0[x]] * wx0 + row0[x1[x]] * wx1) * wy0 +
+						(row1[x0[x]] * wx0 + row1[x1[x]] * wx1) * wy1;
+				}
+			}
+		}, 8);
+	}
+
+	return;
+}
+
+
 cv::Mat Darknet::image_to_mat(const Darknet::Image & img)
 {
 	TAT(TATPARMS);
@@ -1172,21 +1619,17 @@ void Darknet::letterbox_image_into(const Darknet::Image & im, int w, int h, Dark
 {
 	TAT(TATPARMS);
 
-	int new_w = im.w;
-	int new_h = im.h;
-	if (((float)w / im.w) < ((float)h / im.h))
-	{
-		new_w = w;
-		new_h = (im.h * w) / im.w;
-	}
-	else
+	if (boxed.w != w or boxed.h != h or boxed.c != im.c or boxed.data == nullptr)
 	{
-		new_h = h;
-		new_w = (im.w * h) / im.h;
+		darknet_fatal_error(DARKNET_LOC, "cannot letterbox a %d-channel image into a %dx%dx%d image", im.c, boxed.w, boxed.h, boxed.c);
 	}
-	Darknet::Image resized = Darknet::resize_image(im, new_w, new_h);
-	Darknet::embed_image(resized, boxed, (w - new_w) / 2, (h - new_h) / 2);
-	Darknet::free_image(resized);
+
+	// the resized image and the grey border are written directly to the destination, so there are no temporary images
+	const cv::Rect region = letterbox_region(im.w, im.h, w, h);
+	fill_letterbox_border(boxed.data, w, h, boxed.c, region.x, region.y, region.width, region.height, 0.5f);
+	resize_image_region(im, boxed.data, w, h, region.x, region.y, region.width, region.height);
+
+	return;
 }
 
 
@@ -1194,25 +1637,8 @@ Darknet::Image Darknet::letterbox_image(const Darknet::Image & im, int w, int h)
 {
 	TAT(TATPARMS);
 
-	int new_w = im.w;
-	int new_h = im.h;
-	if (((float)w / im.w) < ((float)h / im.h))
-	{
-		new_w = w;
-		new_h = (im.h * w) / im.w;
-	}
-	else
-	{
-		new_h = h;
-		new_w = (im.w * h) / im.h;
-	}
-	Darknet::Image resized = Darknet::resize_image(im, new_w, new_h);
 	Darknet::Image boxed = make_image(w, h, im.c);
-	Darknet::fill_image(boxed, .5);
-	//int i;
-	//for(i = 0; i < boxed.w*boxed.h*boxed.c; ++i) boxed.data[i] = 0;
-	Darknet::embed_image(resized, boxed, (w - new_w) / 2, (h - new_h) / 2);
-	Darknet::free_image(resized);
+	letterbox_image_into(im, w, h, boxed);
 
 	return boxed;
 }
@@ -1484,21 +1910,42 @@ void Darknet::distort_image(Darknet::Image & im, float hue, float sat, float val
 
 	if (im.c >= 3)
 	{
-		rgb_to_hsv(im);
-		scale_image_channel(im, 1, sat);
-		scale_image_channel(im, 2, val);
+		/* Convert the first 3 planes to HSV in a single (vectorized) pass through OpenCV instead of calling
+		 * get_pixel() and set_pixel() for every channel of every pixel.  Note that OpenCV uses degrees for the hue of
+		 * floating point images.
+		 */
+		std::vector<cv::Mat> planes;
+		for (int c = 0; c < 3; c ++)
+		{
+			planes.push_back(cv::Mat(im.h, im.w, CV_32FC1, im.data + c * im.w * im.h));
+		}
+
+		cv::Mat mat;
+		cv::merge(planes, mat);
+		cv::cvtColor(mat, mat, cv::COLOR_RGB2HSV);
 
-		for (int i = 0; i < im.w*im.h; ++i)
+		const float hue_shift = 360.0f * hue;
+		for (int y = 0; y < mat.rows; y ++)
 		{
-			im.data[i] = im.data[i] + hue;
-			if (im.data[i] > 1) im.data[i] -= 1.0f;
-			if (im.data[i] < 0) im.data[i] += 1.0f;
+			cv::Vec3f * ptr = mat.ptr<cv::Vec3f>(y);
+			for (int x = 0; x < mat.cols; x ++)
+			{
+				float & h = ptr[x][0];
+				h += hue_shift;
+				if (h >= 360.0f)	h -= 360.0f;
+				if (h < 0.0f)		h += 360.0f;
+				ptr[x][1] *= sat;
+				ptr[x][2] *= val;
+			}
 		}
-		Darknet::hsv_to_rgb(im);
+
+		cv::cvtColor(mat, mat, cv::COLOR_HSV2RGB);
+		cv::split(mat, planes); // the planes point to im.data, so this writes the results back into the image
 	}
 	else
 	{
-		scale_image_channel(im, 0, val);
+		cv::Mat plane(im.h, im.w, CV_32FC1, im.data);
+		plane *= val;
 	}
 
 	constrain_image(im);
@@ -1632,63 +2079,24 @@ Darknet::Image Darknet::resize_image(const Darknet::Image & im, int w, int h)
 	}
 
 	Darknet::Image resized = make_image(w, h, im.c);
-	Darknet::Image part = make_image(w, im.h, im.c);
-
-	const float w_scale = (im.w - 1.0f) / (w - 1.0f);
-	const float h_scale = (im.h - 1.0f) / (h - 1.0f);
+	resize_image_into(im, resized);
 
-	for (int k = 0; k < im.c; ++k)
-	{
-		for (int r = 0; r < im.h; ++r)
-		{
-			for (int c = 0; c < w; ++c)
-			{
-				float val = 0;
-				if (c == w-1 || im.w == 1)
-				{
-					val = get_pixel(im, im.w-1, r, k);
-				}
-				else
-				{
-					float sx = c*w_scale;
-					int ix = (int) sx;
-					float dx = sx - ix;
-					val = (1 - dx) * get_pixel(im, ix, r, k) + dx * get_pixel(im, ix+1, r, k);
-				}
-				set_pixel(part, c, r, k, val);
-			}
-		}
-	}
+	return resized;
+}
 
-	for (int k = 0; k < im.c; ++k)
-	{
-		for (int r = 0; r < h; ++r)
-		{
-			float sy = r*h_scale;
-			int iy = (int) sy;
-			float dy = sy - iy;
-			for (int c = 0; c < w; ++c)
-			{
-				float val = (1-dy) * get_pixel(part, c, iy, k);
-				set_pixel(resized, c, r, k, val);
-			}
 
-			if (r == h-1 || im.h == 1)
-			{
-				continue;
-			}
+void Darknet::resize_image_into(const Darknet::Image & im, Darknet::Image & resized)
+{
+	TAT(TATPARMS);
 
-			for (int c = 0; c < w; ++c)
-			{
-				float val = dy * get_pixel(part, c, iy+1, k);
-				add_pixel(resized, c, r, k, val);
-			}
-		}
+	if (resized.c != im.c or resized.data == nullptr)
+	{
+		darknet_fatal_error(DARKNET_LOC, "cannot resize a %d-channel image into a %d-channel image", im.c, resized.c);
 	}
 
-	Darknet::free_image(part);
+	resize_image_region(im, resized.data, resized.w, resized.h, 0, 0, resized.w, resized.h);
 
-	return resized;
+	return;
 }
 
 
@@ -1750,13 +2158,72 @@ DarknetImage load_image_v2(const char * filename, int desired_width, int desired
 }
 
 
+cv::Mat Darknet::load_mat_image_scaled(const std::filesystem::path & filename, const cv::Size & minimum_size, cv::Size & original_size, const int flags)
+{
+	TAT(TATPARMS);
+
+	original_size = cv::Size();
+
+	/* JPEG images can be decoded at 1/2, 1/4, or 1/8 of the original size, in which case libjpeg skips most of the
+	 * inverse DCT work.  This is much faster than decoding the full image only to then shrink it down to the network
+	 * dimensions.  Use the smallest scale where both sides are still at least as large as the minimum size.  We use the
+	 * largest side of the minimum size since the EXIF orientation may swap the image width and height.
+	 */
+	int reduction = 1;
+	const cv::Size header_size = (minimum_size.width > 0 and minimum_size.height > 0) ? read_jpeg_dimensions(filename) : cv::Size();
+	if (header_size.width > 0 and (flags == cv::IMREAD_COLOR or flags == cv::IMREAD_GRAYSCALE))
+	{
+		const int minimum = std::max(minimum_size.width, minimum_size.height);
+		for (const int scale : {8, 4, 2})
+		{
+			// libjpeg rounds up when scaling
+			const int w = (header_size.width	+ scale - 1) / scale;
+			const int h = (header_size.height	+ scale - 1) / scale;
+			if (w >= minimum and h >= minimum)
+			{
+				reduction = scale;
+				break;
+			}
+		}
+	}
+
+	int read_flags = flags;
+	if (reduction == 2) read_flags = (flags == cv::IMREAD_COLOR ? cv::IMREAD_REDUCED_COLOR_2 : cv::IMREAD_REDUCED_GRAYSCALE_2);
+	if (reduction == 4) read_flags = (flags == cv::IMREAD_COLOR ? cv::IMREAD_REDUCED_COLOR_4 : cv::IMREAD_REDUCED_GRAYSCALE_4);
+	if (reduction == 8) read_flags = (flags == cv::IMREAD_COLOR ? cv::IMREAD_REDUCED_COLOR_8 : cv::IMREAD_REDUCED_GRAYSCALE_8);
+
+	cv::Mat mat = cv::imread(filename.string(), read_flags);
+	if (mat.empty())
+	{
+		return mat;
+	}
+
+	original_size = mat.size();
+	if (reduction > 1)
+	{
+		// OpenCV applies the EXIF orientation, so the header dimensions may need to be swapped to match the image
+		original_size = header_size;
+		const int64_t same		= std::abs(static_cast<int64_t>(mat.cols) * header_size.height	- static_cast<int64_t>(mat.rows) * header_size.width);
+		const int64_t swapped	= std::abs(static_cast<int64_t>(mat.cols) * header_size.width	- static_cast<int64_t>(mat.rows) * header_size.height);
+		if (swapped < same)
+		{
+			std::swap(original_size.width, original_size.height);
+		}
+	}
+
+	return mat;
+}
+
+
 Darknet::Image Darknet::load_image(const char * filename, int desired_width, int desired_height, int channels)
 {
 	TAT(TATPARMS);
 
 	Darknet::Image image;
 
-	cv::Mat mat = cv::imread(filename);
+	// when we know the image is about to be resized, the decoder can skip much of the work
+	cv::Size original_size;
+	cv::Mat mat = load_mat_image_scaled(filename, cv::Size(desired_width, desired_height), original_size);
 	if (mat.empty())
 	{
 		darknet_fatal_error(DARKNET_LOC, "failed to load image file \"%s\"", filename);
@@ -35,6 +35,21 @@ namespace Darknet
 	 */
 	Darknet::Image load_image(const char * filename, int desired_width = 0, int desired_height = 0, int channels = 0);
 
+	/** Load the given image using OpenCV, decoding it at a reduced size when possible.  JPEG images can be decoded
+	 * directly at 1/2, 1/4, or 1/8 scale, which is several times faster than decoding the full image and resizing it
+	 * afterwards.  The smallest scale where both the image width and height remain at least as large as the largest
+	 * side of @p minimum_size is used.  Other image formats, or an empty @p minimum_size, are decoded at full size.
+	 *
+	 * @param [in] flags Only @p cv::IMREAD_COLOR and @p cv::IMREAD_GRAYSCALE can be reduced.
+	 * @param [out] original_size The full dimensions of the image, read from the JPEG header, for use when scaling
+	 * the bounding boxes back to the original image.
+	 *
+	 * The image returned is in the usual OpenCV @em BGR format, or empty if the image could not be read.
+	 *
+	 * @since 2026-10-18
+	 */
+	cv::Mat load_mat_image_scaled(const std::filesystem::path & filename, const cv::Size & minimum_size, cv::Size & original_size, const int flags = cv::IMREAD_COLOR);
+
 	/** Convert an OpenCV @p cv::Mat object to @ref Darknet::Image.  The @p cv::Mat is expected to already have been
 	 * converted from @p BGR to @p RGB.  The result @ref Darknet::Image floats will be normalized between @p 0.0 and @p 1.0.
 	 * Remember to call @ref Darknet::free_image() when done.
@@ -58,6 +73,23 @@ namespace Darknet
 	 */
 	Darknet::Image bgr_mat_to_rgb_image(const cv::Mat & mat);
 
+	/** Convert an OpenCV BGR or BGRA image directly into the planar RGB floats expected by the neural network.  The
+	 * resize, the channel swap, the normalization to @p 0.0-1.0, and the conversion from interleaved to planar all
+	 * happen in a single pass, without any temporary images.  Rows are processed in parallel.  The loops are scalar
+	 * code which relies on the compiler to auto-vectorize them.
+	 *
+	 * @p dst must have room for @p w * @p h * @p c floats.  At most 3 planes (R, G, B) are written, so when @p c is
+	 * @p 1 only the red plane is written.  With @ref Darknet::EResizeMode::LETTERBOX, the borders are
+	 * set to @p 0.5, and the image is placed the same way as @ref Darknet::letterbox_image().  Callers which re-use the
+	 * same destination for a stream of images of identical size can set @p fill_border to @p false, since the border
+	 * from the previous image is still valid.
+	 *
+	 * Only 8-bit images with 3 or 4 channels are supported.
+	 *
+	 * @since 2026-10-18
+	 */
+	void bgr_mat_to_planar_rgb(const cv::Mat & mat, const int w, const int h, const int c, const Darknet::EResizeMode mode, float * dst, const bool fill_border = true);
+
 	/** Convert the usual @ref Darknet::Image format to OpenCV @p cv::Mat.  The mat object will be in @p RGB format,
 	 * not @p BGR.
 	 *
@@ -143,8 +175,18 @@ namespace Darknet
 	/// Do the equivalent of OpenCV's @p cv::COLOR_BGR2RGB to swap red and blue floats.
 	void rgbgr_image(Darknet::Image & im);
 
+	/** Bilinear resize of the image.  The corners of the source and destination images are aligned.  Remember to call
+	 * @ref Darknet::free_image() when done.  @see @ref Darknet::resize_image_into()
+	 */
 	Darknet::Image resize_image(const Darknet::Image & im, int w, int h);
 
+	/** Same as @ref Darknet::resize_image(), but the results are written to an image which has already been allocated by
+	 * the caller.  The destination dimensions are taken from @p resized, and the number of channels must match.
+	 *
+	 * @since 2026-10-18
+	 */
+	void resize_image_into(const Darknet::Image & im, Darknet::Image & resized);
+
 	/// @note Function currently seems to be unused.
 	Darknet::Image resize_min(const Darknet::Image & im, int min);
 
@@ -186,7 +228,15 @@ namespace Darknet
 	void hsv_to_rgb(Darknet::Image & im);
 
 	Darknet::Image letterbox_image(const Darknet::Image & im, int w, int h);
+
+	/** Letterbox @p im into the existing image @p boxed, which must be @p w x @p h with the same number of channels.
+	 * The scaled image and the grey border are both written directly to @p boxed in a single pass, so no temporary
+	 * images are created.
+	 *
+	 * @since 2026-10-18
+	 */
 	void letterbox_image_into(const Darknet::Image & im, int w, int h, Darknet::Image & boxed);
+
 	void random_distort_image(Darknet::Image & im, float hue, float saturation, float exposure);
 	void translate_image(Darknet::Image m, float s);
 	void distort_image(Darknet::Image & im, float hue, float sat, float val);
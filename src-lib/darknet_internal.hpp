@@ -27,7 +27,9 @@
 #include <condition_variable>
 #include <deque>
 #include <fstream>
+#include <functional>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <random>
@@ -352,3 +354,8 @@ int get_yolo_detections_v3(Darknet::Network * net, int w, int h, int netw, int n
 #include "tree.hpp"
 #include "activations.hpp"
 #include "dump.hpp"
+#include "darknet_worker_pool.hpp"
+#include "darknet_numa.hpp"
+#include "darknet_dataset_pack.hpp"
+#include "darknet_label_cache.hpp"
+#include "darknet_tar_dataset.hpp"
@@ -0,0 +1,321 @@
+#include "darknet_internal.hpp"
+
+#include <shared_mutex>
+#include <unordered_map>
+
+
+namespace
+{
+	/// Every label cache file starts with these 8 bytes.
+	static const char label_cache_magic[8] = {'D', 'N', 'L', 'A', 'B', 'E', 'L', '\0'};
+
+	/// Increment this if the layout of the label cache file changes.
+	static const uint32_t label_cache_version = 1;
+
+	struct LabelCacheHeader
+	{
+		char		magic[8];
+		uint32_t	version;
+		uint32_t	entries;
+	};
+
+	/** Each entry in the label cache file is the length of the image filename, the filename itself, this structure,
+	 * and then the @ref box_label structures.
+	 */
+	struct LabelCacheEntry
+	{
+		int64_t		timestamp;	///< last write time of the annotation file
+		uint64_t	size;		///< size of the annotation file in bytes
+		uint32_t	count;		///< number of bounding boxes
+	};
+
+	/// The annotations for one image, while the cache is being loaded.
+	struct LabelResult
+	{
+		bool					found		= false;
+		bool					reloaded	= false;
+		LabelCacheEntry			entry		= {};
+		std::vector<box_label>	boxes;
+	};
+
+	/// @{ The bounding boxes for all the images, and where to find the boxes for each image.  Protected by @ref label_cache_mutex.
+	static std::shared_mutex label_cache_mutex;
+	static std::vector<box_label> label_boxes;
+	static std::unordered_map<std::string, std::pair<size_t, int>> label_index;
+	static std::set<std::filesystem::path> label_cache_lists;
+	/// @}
+
+
+	/// For example, @p "cars_train.txt" becomes @p "cars_train.labels".
+	static inline std::filesystem::path label_cache_filename(const std::filesystem::path & list_filename)
+	{
+		TAT(TATPARMS);
+
+		std::filesystem::path path = list_filename;
+		path.replace_extension(".labels");
+
+		return path;
+	}
+
+
+	/// Read the label cache file.  The result is the file content, and the offset of each entry within that content.
+	static inline std::string read_label_cache_file(const std::filesystem::path & filename, std::unordered_map<std::string, size_t> & entries)
+	{
+		TAT(TATPARMS);
+
+		std::string content;
+
+		std::ifstream ifs(filename, std::ios::binary);
+		if (not ifs.good())
+		{
+			return content;
+		}
+
+		// read the entire file at once
+		const auto size = std::filesystem::file_size(filename);
+		content.resize(size);
+		ifs.read(content.data(), size);
+		if (not ifs.good() or size < sizeof(LabelCacheHeader))
+		{
+			return std::string();
+		}
+
+		LabelCacheHeader header;
+		std::memcpy(&header, content.data(), sizeof(header));
+		if (std::memcmp(header.magic, label_cache_magic, sizeof(header.magic)) != 0 or header.version != label_cache_version)
+		{
+			return std::string();
+		}
+
+		size_t offset = sizeof(header);
+		for (uint32_t idx = 0; idx < header.entries; idx ++)
+		{
+			uint32_t length = 0;
+			if (offset + sizeof(length) > content.size())
+			{
+				break;
+			}
+			std::memcpy(&length, content.data() + offset, sizeof(length));
+			offset += sizeof(length);
+
+			if (offset + length + sizeof(LabelCacheEntry) > content.size())
+			{
+				break;
+			}
+			const std::string image_filename = content.substr(offset, length);
+			offset += length;
+
+			LabelCacheEntry entry;
+			std::memcpy(&entry, content.data() + offset, sizeof(entry));
+			if (offset + sizeof(entry) + entry.count * sizeof(box_label) > content.size())
+			{
+				break;
+			}
+			entries[image_filename] = offset;
+			offset += sizeof(entry) + entry.count * sizeof(box_label);
+		}
+
+		return content;
+	}
+
+
+	static inline void write_label_cache_file(const std::filesystem::path & filename, char ** paths, const std::vector<LabelResult> & results)
+	{
+		TAT(TATPARMS);
+
+		LabelCacheHeader header;
+		std::memcpy(header.magic, label_cache_magic, sizeof(header.magic));
+		header.version = label_cache_version;
+		header.entries = 0;
+		for (const auto & result : results)
+		{
+			if (result.found)
+			{
+				header.entries ++;
+			}
+		}
+
+		// write to a temporary file first so an interrupted run doesn't leave behind a corrupt cache
+		std::filesystem::path tmp = filename;
+		tmp += ".tmp";
+
+		std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+		ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		for (size_t idx = 0; idx < results.size(); idx ++)
+		{
+			const auto & result = results[idx];
+			if (result.found)
+			{
+				const uint32_t length = std::strlen(paths[idx]);
+				ofs.write(reinterpret_cast<const char *>(&length), sizeof(length));
+				ofs.write(paths[idx], length);
+				ofs.write(reinterpret_cast<const char *>(&result.entry), sizeof(result.entry));
+				ofs.write(reinterpret_cast<const char *>(result.boxes.data()), result.boxes.size() * sizeof(box_label));
+			}
+		}
+		ofs.close();
+
+		std::error_code ec;
+		if (ofs.good())
+		{
+			std::filesystem::rename(tmp, filename, ec);
+		}
+		if (ec or not ofs.good())
+		{
+			// not being able to save the cache is not fatal, it just means the annotations are parsed again next time
+			std::filesystem::remove(tmp, ec);
+			Darknet::display_warning_msg("Failed to save the label cache " + filename.string() + ".\n");
+		}
+
+		return;
+	}
+}
+
+
+void Darknet::load_label_cache(const std::filesystem::path & list_filename)
+{
+	TAT(TATPARMS);
+
+	if (true)
+	{
+		std::shared_lock lock(label_cache_mutex);
+		if (label_cache_lists.count(list_filename))
+		{
+			return;
+		}
+	}
+
+	list * plist = get_paths(list_filename.string().c_str());
+	char ** paths = (char **)list_to_array(plist);
+	const int number_of_images = plist->size;
+
+	const auto cache_filename = label_cache_filename(list_filename);
+	std::unordered_map<std::string, size_t> cached_entries;
+	const std::string cached_content = read_label_cache_file(cache_filename, cached_entries);
+
+	std::vector<LabelResult> results(number_of_images);
+
+	// looking at the timestamps is much faster than parsing the annotations, but on network drives it still helps to do it in parallel
+	Darknet::parallel_for(0, number_of_images, [&](const int idx)
+	{
+		auto & result = results[idx];
+
+		char labelpath[4096];
+		replace_image_to_label(paths[idx], labelpath);
+
+		std::error_code ec;
+		result.entry.size = std::filesystem::file_size(labelpath, ec);
+		if (ec)
+		{
+			// no annotation file -- leave it to read_boxes() to complain if this image is used
+			return;
+		}
+		result.entry.timestamp = std::filesystem::last_write_time(labelpath, ec).time_since_epoch().count();
+		if (ec)
+		{
+			return;
+		}
+		result.found = true;
+
+		const auto iter = cached_entries.find(paths[idx]);
+		if (iter != cached_entries.end())
+		{
+			LabelCacheEntry entry;
+			std::memcpy(&entry, cached_content.data() + iter->second, sizeof(entry));
+			if (entry.timestamp == result.entry.timestamp and entry.size == result.entry.size)
+			{
+				result.entry.count = entry.count;
+				result.boxes.resize(entry.count);
+				std::memcpy(result.boxes.data(), cached_content.data() + iter->second + sizeof(entry), entry.count * sizeof(box_label));
+				return;
+			}
+		}
+
+		// the annotation file is new or has changed
+		int count = 0;
+		box_label * boxes = read_boxes(labelpath, &count);
+		result.boxes.assign(boxes, boxes + count);
+		result.entry.count = count;
+		result.reloaded = true;
+		free(boxes);
+	}, 64);
+
+	size_t images_found		= 0;
+	size_t images_reloaded	= 0;
+	size_t total_boxes		= 0;
+
+	if (true)
+	{
+		std::unique_lock lock(label_cache_mutex);
+
+		for (int idx = 0; idx < number_of_images; idx ++)
+		{
+			const auto & result = results[idx];
+			if (result.found)
+			{
+				images_found ++;
+				images_reloaded += (result.reloaded ? 1 : 0);
+				total_boxes += result.boxes.size();
+
+				label_index[paths[idx]] = {label_boxes.size(), static_cast<int>(result.boxes.size())};
+				label_boxes.insert(label_boxes.end(), result.boxes.begin(), result.boxes.end());
+			}
+		}
+
+		label_cache_lists.insert(list_filename);
+	}
+
+	if (images_reloaded > 0 or images_found != cached_entries.size())
+	{
+		write_label_cache_file(cache_filename, paths, results);
+	}
+
+	std::cout
+		<< "Label cache for " << list_filename.string() << ": "
+		<< images_found << " images, "
+		<< total_boxes << " objects, "
+		<< images_reloaded << " annotation files read." << std::endl;
+
+	free(paths);
+	free_list_contents(plist);
+	free_list(plist);
+
+	return;
+}
+
+
+box_label * Darknet::get_cached_boxes(const char * image_filename, int & count)
+{
+	TAT(TATPARMS);
+
+	count = 0;
+
+	std::shared_lock lock(label_cache_mutex);
+
+	const auto iter = label_index.find(image_filename);
+	if (iter == label_index.end())
+	{
+		return nullptr;
+	}
+
+	// the caller expects to own (and modify) the boxes just like with read_boxes()
+	count = iter->second.second;
+	box_label * boxes = (box_label*)xcalloc(std::max(1, count), sizeof(box_label));
+	std::memcpy(boxes, label_boxes.data() + iter->second.first, count * sizeof(box_label));
+
+	return boxes;
+}
+
+
+void Darknet::clear_label_cache()
+{
+	TAT(TATPARMS);
+
+	std::unique_lock lock(label_cache_mutex);
+
+	label_boxes.clear();
+	label_index.clear();
+	label_cache_lists.clear();
+
+	return;
+}
@@ -0,0 +1,38 @@
+/* Darknet/YOLO:  https://github.com/hank-ai/darknet
+ * Copyright 2024 Stephane Charette
+ */
+
+#pragma once
+
+#include "darknet_internal.hpp"
+
+/** @file
+ * Cache of the annotations (bounding boxes) for each image.  Instead of opening and parsing every @p .txt annotation
+ * file each time an image is used, all the annotation files for a list of images are parsed once -- in parallel --
+ * and stored in memory.  The cache is also saved next to the list of images so the next run only needs to re-read the
+ * annotation files which have changed.
+ *
+ * @see @ref Darknet::load_label_cache()
+ */
+
+
+namespace Darknet
+{
+	/** Read all the annotations for the images in this list, such as @p cars_train.txt or @p cars_valid.txt.  The cache
+	 * is saved as @p cars_train.labels, and is used as long as the size and timestamp of each annotation file has not
+	 * changed.  Calling this multiple times with the same list does nothing.
+	 *
+	 * @since 2026-10-18
+	 */
+	void load_label_cache(const std::filesystem::path & list_filename);
+
+	/** Get a copy of the bounding boxes for this image from the label cache.  The caller must @p free() the returned
+	 * pointer, exactly like @ref read_boxes().  Returns @p nullptr if the image is not in the cache.
+	 *
+	 * @since 2026-10-18
+	 */
+	box_label * get_cached_boxes(const char * image_filename, int & count);
+
+	/// Forget all the annotations which were loaded by @ref load_label_cache().  @since 2026-10-18
+	void clear_label_cache();
+}
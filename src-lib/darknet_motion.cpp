@@ -0,0 +1,255 @@
+#include "darknet_internal.hpp"
+#include "darknet_motion.hpp"
+
+
+namespace
+{
+	/// Width of the greyscale image used to look for motion.  Small enough to be cheap, large enough to find people.
+	constexpr int reduced_width = 160;
+
+	/// Above this fraction of the frame, cropping to the motion saves too little to be worth it.
+	constexpr float maximum_crop_area = 0.5f;
+}
+
+
+Darknet::MotionGate::MotionGate(const Darknet::NetworkPtr ptr) :
+	network_ptr(ptr),
+	pixel_threshold(25),
+	minimum_area(0.002f),
+	crop_to_motion(true),
+	keyframe_interval(0),
+	skipped(false),
+	frames_since_keyframe(0),
+	skipped_counter(0),
+	cropped_counter(0),
+	processed_counter(0)
+{
+	TAT(TATPARMS);
+
+	if (network_ptr == nullptr)
+	{
+		throw std::invalid_argument("cannot create motion gate without a network pointer");
+	}
+
+	return;
+}
+
+
+Darknet::MotionGate::~MotionGate()
+{
+	TAT(TATPARMS);
+
+	return;
+}
+
+
+Darknet::MotionGate & Darknet::MotionGate::set_sensitivity(const int threshold, const float area)
+{
+	TAT(TATPARMS);
+
+	if (threshold < 0 or threshold > 255)
+	{
+		throw std::invalid_argument("motion pixel threshold must be between 0 and 255");
+	}
+	if (area < 0.0f or area > 1.0f)
+	{
+		throw std::invalid_argument("motion minimum area must be between 0.0 and 1.0");
+	}
+
+	pixel_threshold	= threshold;
+	minimum_area	= area;
+
+	return *this;
+}
+
+
+Darknet::MotionGate & Darknet::MotionGate::set_crop_to_motion(const bool toggle)
+{
+	TAT(TATPARMS);
+
+	crop_to_motion = toggle;
+
+	return *this;
+}
+
+
+Darknet::MotionGate & Darknet::MotionGate::set_keyframe_interval(const size_t frames)
+{
+	TAT(TATPARMS);
+
+	keyframe_interval = frames;
+
+	return *this;
+}
+
+
+Darknet::MotionGate & Darknet::MotionGate::reset()
+{
+	TAT(TATPARMS);
+
+	reference.release();
+	last_predictions.clear();
+	frames_since_keyframe = 0;
+
+	return *this;
+}
+
+
+bool Darknet::MotionGate::last_frame_was_skipped() const
+{
+	TAT(TATPARMS);
+
+	return skipped;
+}
+
+
+size_t Darknet::MotionGate::frames_skipped() const
+{
+	TAT(TATPARMS);
+
+	return skipped_counter;
+}
+
+
+size_t Darknet::MotionGate::frames_cropped() const
+{
+	TAT(TATPARMS);
+
+	return cropped_counter;
+}
+
+
+size_t Darknet::MotionGate::frames_processed() const
+{
+	TAT(TATPARMS);
+
+	return processed_counter;
+}
+
+
+cv::Mat Darknet::MotionGate::reduce(const cv::Mat & mat) const
+{
+	TAT(TATPARMS);
+
+	const int width		= std::min(reduced_width, mat.cols);
+	const int height	= std::max(1, mat.rows * width / mat.cols);
+
+	// INTER_AREA averages the pixels, which removes most of the sensor noise
+	cv::Mat small;
+	cv::resize(mat, small, cv::Size(width, height), 0, 0, cv::INTER_AREA);
+
+	if (small.channels() == 3)
+	{
+		cv::cvtColor(small, small, cv::COLOR_BGR2GRAY);
+	}
+	else if (small.channels() == 4)
+	{
+		cv::cvtColor(small, small, cv::COLOR_BGRA2GRAY);
+	}
+
+	cv::GaussianBlur(small, small, cv::Size(3, 3), 0);
+
+	return small;
+}
+
+
+Darknet::Predictions Darknet::MotionGate::predict(const cv::Mat & mat)
+{
+	TAT(TATPARMS);
+
+	if (mat.empty())
+	{
+		throw std::invalid_argument("cannot predict without a valid image");
+	}
+
+	cv::Mat small = reduce(mat);
+
+	frames_since_keyframe ++;
+	const bool keyframe =
+			reference.empty()						or
+			reference.size() != small.size()		or
+			reference.type() != small.type()		or
+			(keyframe_interval > 0 and frames_since_keyframe >= keyframe_interval);
+
+	cv::Rect motion_rect(0, 0, mat.cols, mat.rows);
+
+	if (not keyframe)
+	{
+		// compare against the frame where the network last ran so slow movement eventually adds up
+		cv::Mat mask;
+		cv::absdiff(small, reference, mask);
+		cv::threshold(mask, mask, pixel_threshold, 255, cv::THRESH_BINARY);
+
+		const int changed = cv::countNonZero(mask);
+		if (changed < std::max(1.0f, minimum_area * mask.total()))
+		{
+			skipped = true;
+			skipped_counter ++;
+			return last_predictions;
+		}
+
+		if (crop_to_motion)
+		{
+			// scale the motion back to the full frame, and add a margin so objects which are partially moving are whole
+			const cv::Rect r = cv::boundingRect(mask);
+			const float scale_x = static_cast<float>(mat.cols) / small.cols;
+			const float scale_y = static_cast<float>(mat.rows) / small.rows;
+			cv::Rect2f motion(r.x * scale_x, r.y * scale_y, r.width * scale_x, r.height * scale_y);
+
+			const Darknet::Network * net = reinterpret_cast<const Darknet::Network *>(network_ptr);
+
+			// crops which are smaller than the network would have to be enlarged, so there is no point going below that
+			const float w = std::max({motion.width	* 1.5f, motion.width	+ 32.0f, static_cast<float>(net->w)});
+			const float h = std::max({motion.height	* 1.5f, motion.height	+ 32.0f, static_cast<float>(net->h)});
+			const float cx = motion.x + motion.width / 2.0f;
+			const float cy = motion.y + motion.height / 2.0f;
+
+			motion_rect = cv::Rect(cvRound(cx - w / 2.0f), cvRound(cy - h / 2.0f), cvRound(w), cvRound(h)) & cv::Rect(0, 0, mat.cols, mat.rows);
+			if (motion_rect.area() > maximum_crop_area * mat.total())
+			{
+				motion_rect = cv::Rect(0, 0, mat.cols, mat.rows);
+			}
+		}
+	}
+
+	skipped		= false;
+	reference	= small;
+
+	if (motion_rect.width == mat.cols and motion_rect.height == mat.rows)
+	{
+		processed_counter ++;
+		frames_since_keyframe = 0;
+		last_predictions = Darknet::predict(network_ptr, mat);
+
+		return last_predictions;
+	}
+
+	cropped_counter ++;
+
+	// keep the previous predictions from the part of the frame which has not changed
+	Predictions predictions;
+	for (const auto & pred : last_predictions)
+	{
+		const cv::Point centre(pred.rect.x + pred.rect.width / 2, pred.rect.y + pred.rect.height / 2);
+		if (not motion_rect.contains(centre))
+		{
+			predictions.push_back(pred);
+		}
+	}
+
+	// move the new predictions from the coordinates of the crop to those of the full frame
+	for (auto pred : Darknet::predict(network_ptr, mat(motion_rect)))
+	{
+		pred.rect.x += motion_rect.x;
+		pred.rect.y += motion_rect.y;
+		pred.normalized_point.x	= (motion_rect.x + pred.normalized_point.x * motion_rect.width	) / mat.cols;
+		pred.normalized_point.y	= (motion_rect.y + pred.normalized_point.y * motion_rect.height	) / mat.rows;
+		pred.normalized_size.width	= pred.normalized_size.width	* motion_rect.width	/ mat.cols;
+		pred.normalized_size.height	= pred.normalized_size.height	* motion_rect.height/ mat.rows;
+		predictions.push_back(pred);
+	}
+
+	last_predictions = predictions;
+
+	return last_predictions;
+}
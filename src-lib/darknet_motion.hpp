@@ -0,0 +1,133 @@
+/* Darknet/YOLO:  https://github.com/hank-ai/darknet
+ * Copyright 2024 Stephane Charette
+ */
+
+#pragma once
+
+#ifndef __cplusplus
+#error "The Darknet/YOLO project requires a C++ compiler."
+#endif
+
+/** @file
+ * This file defines @ref Darknet::MotionGate, which skips inference on video frames where nothing has moved.
+ */
+
+
+#include "darknet.hpp"
+
+
+namespace Darknet
+{
+	/** The @p %MotionGate class sits in front of @ref Darknet::predict() when processing video from fixed cameras.
+	 * Each frame is reduced to a small greyscale image and compared against the frame where the network last ran.
+	 *
+	 * @li If nothing has changed, the network is not called and the previous predictions are returned.
+	 * @li If only part of the frame has changed, the network may be called on the region of motion.  The new
+	 * predictions are combined with the previous predictions from the rest of the frame.
+	 * @li Otherwise the network is called on the entire frame.
+	 *
+	 * @code
+	 * Darknet::MotionGate motion_gate(net);
+	 * while (cap.read(frame))
+	 * {
+	 *     const auto predictions = motion_gate.predict(frame);
+	 *     Darknet::annotate(net, predictions, frame);
+	 *     // ...
+	 * }
+	 * @endcode
+	 *
+	 * @since 2026-10-18
+	 */
+	class MotionGate final
+	{
+		public:
+
+			MotionGate() = delete;
+			MotionGate(const MotionGate &) = delete;
+			MotionGate & operator=(const MotionGate &) = delete;
+
+			/** Constructor needs a neural network pointer.  @see @ref Darknet::load_neural_network()
+			 *
+			 * @since 2026-10-18
+			 */
+			MotionGate(const Darknet::NetworkPtr ptr);
+
+			/// Destructor.
+			~MotionGate();
+
+			/** Get the predictions for this video frame.  Depending on how much of the frame has changed, this may or
+			 * may not call the neural network.  @see @ref last_frame_was_skipped()
+			 *
+			 * @since 2026-10-18
+			 */
+			Predictions predict(const cv::Mat & mat);
+
+			/** Set how sensitive the motion detection is.
+			 *
+			 * @param [in] pixel_threshold How much a pixel of the reduced greyscale image must change (0-255) before it
+			 * is considered to have moved.  Default is @p 25.
+			 * @param [in] minimum_area Fraction of the frame which must have moved before the network is called.  Default
+			 * is @p 0.002, or 0.2% of the frame.
+			 *
+			 * @since 2026-10-18
+			 */
+			MotionGate & set_sensitivity(const int pixel_threshold, const float minimum_area);
+
+			/** When enabled, frames where the motion is limited to a small part of the image only send that region to the
+			 * neural network.  Default is @p true.
+			 *
+			 * @since 2026-10-18
+			 */
+			MotionGate & set_crop_to_motion(const bool toggle);
+
+			/** Force the network to run on the entire frame at least once every @p frames frames, regardless of motion.
+			 * This catches slow changes such as lighting.  Default is @p 0, meaning never.
+			 *
+			 * @since 2026-10-18
+			 */
+			MotionGate & set_keyframe_interval(const size_t frames);
+
+			/** Forget the previous frame and predictions.  Call this when the video source changes.  The next frame will
+			 * always be sent to the neural network.
+			 *
+			 * @since 2026-10-18
+			 */
+			MotionGate & reset();
+
+			/// Whether the neural network was skipped for the most recent frame.  @since 2026-10-18
+			bool last_frame_was_skipped() const;
+
+			/// Number of frames where the neural network was not called.  @since 2026-10-18
+			size_t frames_skipped() const;
+
+			/// Number of frames where the neural network was called on part of the frame.  @since 2026-10-18
+			size_t frames_cropped() const;
+
+			/// Number of frames where the neural network was called on the entire frame.  @since 2026-10-18
+			size_t frames_processed() const;
+
+		private:
+
+			/// Reduce the frame to the small greyscale image used to look for motion.
+			cv::Mat reduce(const cv::Mat & mat) const;
+
+			const Darknet::NetworkPtr network_ptr;
+
+			int pixel_threshold;
+			float minimum_area;
+			bool crop_to_motion;
+			size_t keyframe_interval;
+
+			/// Reduced version of the frame where the neural network last ran.
+			cv::Mat reference;
+
+			/// The most recent predictions, returned as-is when nothing moves.
+			Predictions last_predictions;
+
+			bool skipped;
+			size_t frames_since_keyframe;
+			size_t skipped_counter;
+			size_t cropped_counter;
+			size_t processed_counter;
+	};
+}
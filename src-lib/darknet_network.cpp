@@ -4,6 +4,187 @@
 namespace
 {
 	static auto & cfg_and_state = Darknet::CfgAndState::get();
+
+
+	/** Work out which layers must complete before each layer can start.  Most layers consume the output of the previous
+	 * layer, but route layers only read the layers they reference, which is what allows branches to run side-by-side.
+	 */
+	static inline void build_layer_graph(Darknet::Network & net)
+	{
+		TAT(TATPARMS);
+
+		auto & details = *net.details;
+		details.layer_dependents		.assign(net.n, Darknet::VInt());
+		details.layer_dependency_count	.assign(net.n, 0);
+
+		// the "level" is the longest chain of layers leading to this one; layers on the same level are independent
+		Darknet::VInt level(net.n, 0);
+		std::map<int, size_t> layers_per_level;
+
+		for (int idx = 0; idx < net.n; idx ++)
+		{
+			const Darknet::Layer & l = net.layers[idx];
+
+			Darknet::SInt dependencies;
+			if (idx > 0 and l.type != Darknet::ELayerType::ROUTE)
+			{
+				dependencies.insert(idx - 1);
+			}
+			if ((l.type == Darknet::ELayerType::ROUTE or l.type == Darknet::ELayerType::SHORTCUT) and l.input_layers)
+			{
+				for (int k = 0; k < l.n; k ++)
+				{
+					dependencies.insert(l.input_layers[k]);
+				}
+			}
+			if (l.type == Darknet::ELayerType::SHORTCUT or
+				l.type == Darknet::ELayerType::SCALE_CHANNELS or
+				l.type == Darknet::ELayerType::SAM)
+			{
+				dependencies.insert(l.index);
+			}
+			if ((l.type == Darknet::ELayerType::YOLO or l.type == Darknet::ELayerType::GAUSSIAN_YOLO) and l.embedding_output)
+			{
+				dependencies.insert(l.embedding_layer_id);
+			}
+
+			for (const int dependency : dependencies)
+			{
+				if (dependency >= 0 and dependency < idx)
+				{
+					details.layer_dependents[dependency].push_back(idx);
+					details.layer_dependency_count[idx] ++;
+					level[idx] = std::max(level[idx], level[dependency] + 1);
+				}
+			}
+
+			layers_per_level[level[idx]] ++;
+		}
+
+		details.max_concurrent_layers = 1;
+		for (const auto & [lvl, count] : layers_per_level)
+		{
+			details.max_concurrent_layers = std::max(details.max_concurrent_layers, count);
+		}
+
+		if (cfg_and_state.is_verbose)
+		{
+			std::cout << "Layer graph has " << layers_per_level.size() << " levels, up to " << details.max_concurrent_layers << " layers can run concurrently" << std::endl;
+		}
+
+		return;
+	}
+
+
+	/** Same as @ref forward_network() but with the layers scheduled according to the dependency graph.  Several "lanes"
+	 * pull layers from a shared queue as soon as all of their inputs are available.  Each lane has its own workspace,
+	 * and the thread budget is split between the lanes.
+	 */
+	static inline void forward_network_concurrent_branches(Darknet::Network & net, Darknet::NetworkState state)
+	{
+		TAT(TATPARMS);
+
+		auto & details = *net.details;
+		if (details.layer_dependency_count.size() != static_cast<size_t>(net.n))
+		{
+			build_layer_graph(net);
+		}
+
+		auto & pool = Darknet::WorkerPool::current();
+		const size_t budget = Darknet::WorkerPool::current_budget() > 0 ? Darknet::WorkerPool::current_budget() : pool.size() + 1;
+		const size_t lanes = std::max<size_t>(1, std::min(budget, details.max_concurrent_layers));
+		const size_t threads_per_lane = std::max<size_t>(1, budget / lanes);
+
+		size_t workspace_size = 0;
+		for (int idx = 0; idx < net.n; idx ++)
+		{
+			workspace_size = std::max(workspace_size, net.layers[idx].workspace_size);
+		}
+		details.branch_workspaces.resize(lanes - 1);
+		for (auto & workspace : details.branch_workspaces)
+		{
+			if (workspace.size() < workspace_size / sizeof(float) + 1)
+			{
+				workspace.resize(workspace_size / sizeof(float) + 1);
+			}
+		}
+
+		float * original_input = state.input;
+		Darknet::VInt dependency_count = details.layer_dependency_count;
+		std::deque<int> ready;
+		for (int idx = 0; idx < net.n; idx ++)
+		{
+			if (dependency_count[idx] == 0)
+			{
+				ready.push_back(idx);
+			}
+		}
+
+		int remaining = net.n;
+		bool failed = false;
+		std::mutex mtx;
+		std::condition_variable cv;
+
+		std::vector<Darknet::WorkerPool::Task> tasks;
+		for (size_t lane = 0; lane < lanes; lane ++)
+		{
+			tasks.push_back([&, lane]()
+			{
+				Darknet::WorkerPool::Scope lane_scope(&pool, threads_per_lane);
+
+				Darknet::NetworkState lane_state = state;
+				lane_state.workspace = (lane == 0 ? net.workspace : details.branch_workspaces[lane - 1].data());
+
+				while (true)
+				{
+					int idx = -1;
+					if (true)
+					{
+						std::unique_lock lock(mtx);
+						cv.wait(lock, [&]{ return failed or remaining == 0 or not ready.empty(); });
+						if (failed or ready.empty())
+						{
+							break;
+						}
+						idx = ready.front();
+						ready.pop_front();
+					}
+
+					Darknet::Layer & l = net.layers[idx];
+					lane_state.index = idx;
+					lane_state.input = (idx == 0 ? original_input : net.layers[idx - 1].output);
+
+					try
+					{
+						l.forward(l, lane_state);
+					}
+					catch (...)
+					{
+						std::scoped_lock lock(mtx);
+						failed = true;
+						cv.notify_all();
+						throw;
+					}
+
+					std::scoped_lock lock(mtx);
+					remaining --;
+					for (const int dependent : details.layer_dependents[idx])
+					{
+						dependency_count[dependent] --;
+						if (dependency_count[dependent] == 0)
+						{
+							ready.push_back(dependent);
+						}
+					}
+					cv.notify_all();
+				}
+			});
+		}
+
+		pool.run_concurrently(tasks, lanes);
+
+		return;
+	}
 }
 
 
@@ -25,6 +206,19 @@ Darknet::NetworkDetails::NetworkDetails()
 	annotate_draw_bb						= true;
 	annotate_draw_label						= true;
 
+	resize_mode								= Darknet::EResizeMode::NEAREST;
+	tiled_inference							= false;
+	tile_size								= cv::Size(0, 0);
+	tile_overlap							= 0.2f;
+	tile_full_frame							= true;
+	thread_budget							= 0;
+	concurrent_branches						= false;
+	max_concurrent_layers					= 1;
+	numa_node								= -1;
+	images_processed						= 0;
+	workspace_capacity						= 0;
+	inference_nanoseconds					= 0;
+
 	return;
 }
 
@@ -230,6 +424,15 @@ void forward_network(Darknet::Network & net, Darknet::NetworkState state)
 {
 	TAT(TATPARMS);
 
+	// limit how many of the worker pool threads the CPU layers are allowed to use
+	Darknet::WorkerPool::Scope scope(net.details ? net.details->worker_pool.get() : nullptr, net.details ? net.details->thread_budget : 0);
+
+	if (net.details and net.details->concurrent_branches and state.train == 0)
+	{
+		forward_network_concurrent_branches(net, state);
+		return;
+	}
+
 	state.workspace = net.workspace;
 
 	for (int i = 0; i < net.n; ++i)
@@ -317,6 +520,8 @@ void backward_network(Darknet::Network & net, Darknet::NetworkState state)
 {
 	TAT(TATPARMS);
 
+	Darknet::WorkerPool::Scope scope(net.details ? net.details->worker_pool.get() : nullptr, net.details ? net.details->thread_budget : 0);
+
 	float *original_input = state.input;
 	float *original_delta = state.delta;
 	state.workspace = net.workspace;
@@ -561,6 +766,7 @@ int recalculate_workspace_size(Darknet::Network * net)
 	free(net->workspace);
 	net->workspace = (float*)xcalloc(1, workspace_size);
 #endif
+	net->details->workspace_capacity = workspace_size;
 	//fprintf(stderr, " Done!\n");
 	return 0;
 }
@@ -600,7 +806,6 @@ int resize_network(Darknet::Network * net, int w, int h)
 	cuda_set_device(net->gpu_index);
 	if(cfg_and_state.gpu_index >= 0)
 	{
-		cuda_free(net->workspace);
 		if (net->input_gpu)
 		{
 			cuda_free(*net->input_gpu);
@@ -691,12 +896,27 @@ int resize_network(Darknet::Network * net, int w, int h)
 		//if(l.type == AVGPOOL) break;
 	}
 
-	std::cout << "Allocating workspace:  " << size_to_IEC_string(workspace_size) << std::endl;
+	// when the network shrinks the existing workspace is large enough and is kept as-is
+	const bool reuse_workspace = (net->workspace and workspace_size <= net->details->workspace_capacity);
+	if (reuse_workspace)
+	{
+		std::cout << "Reusing workspace:  " << size_to_IEC_string(net->details->workspace_capacity) << std::endl;
+	}
+	else
+	{
+		std::cout << "Allocating workspace:  " << size_to_IEC_string(workspace_size) << std::endl;
+		net->details->workspace_capacity = workspace_size;
+	}
+
 #ifdef GPU
 	const int size = get_network_input_size(*net) * net->batch;
 	if (cfg_and_state.gpu_index >= 0)
 	{
-		net->workspace = cuda_make_array(0, workspace_size/sizeof(float) + 1);
+		if (not reuse_workspace)
+		{
+			cuda_free(net->workspace);
+			net->workspace = cuda_make_array(0, workspace_size/sizeof(float) + 1);
+		}
 		net->input_state_gpu = cuda_make_array(0, size);
 		if (cudaSuccess == cudaHostAlloc((void**)&net->input_pinned_cpu, size * sizeof(float), cudaHostRegisterMapped))
 		{
@@ -712,16 +932,22 @@ int resize_network(Darknet::Network * net, int w, int h)
 	}
 	else
 	{
-		free(net->workspace);
-		net->workspace = (float*)xcalloc(1, workspace_size);
+		if (not reuse_workspace)
+		{
+			free(net->workspace);
+			net->workspace = (float*)xcalloc(1, workspace_size);
+		}
 		if (!net->input_pinned_cpu_flag)
 		{
 			net->input_pinned_cpu = (float*)xrealloc(net->input_pinned_cpu, size * sizeof(float));
 		}
 	}
 #else
-	free(net->workspace);
-	net->workspace = (float*)xcalloc(1, workspace_size);
+	if (not reuse_workspace)
+	{
+		free(net->workspace);
+		net->workspace = (float*)xcalloc(1, workspace_size);
+	}
 #endif
 	if (net->workspace == NULL)
 	{
@@ -828,22 +1054,35 @@ float *network_predict(Darknet::Network & net, float * input)
 {
 	TAT(TATPARMS);
 
+	const auto timestamp_begin = std::chrono::high_resolution_clock::now();
+
+	float *out = nullptr;
+
 #ifdef GPU
 	if (cfg_and_state.gpu_index >= 0)
 	{
-		return network_predict_gpu(net, input);
+		out = network_predict_gpu(net, input);
 	}
+	else
 #endif
+	{
+		Darknet::NetworkState state = {0};
+		state.net = net;
+		state.index = 0;
+		state.input = input;
+		state.truth = 0;
+		state.train = 0;
+		state.delta = 0;
+		forward_network(net, state);
+		out = get_network_output(net);
+	}
 
-	Darknet::NetworkState state = {0};
-	state.net = net;
-	state.index = 0;
-	state.input = input;
-	state.truth = 0;
-	state.train = 0;
-	state.delta = 0;
-	forward_network(net, state);
-	float *out = get_network_output(net);
+	if (net.details)
+	{
+		const auto timestamp_end = std::chrono::high_resolution_clock::now();
+		net.details->images_processed += net.batch;
+		net.details->inference_nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp_end - timestamp_begin).count();
+	}
 
 	return out;
 }
@@ -1408,6 +1647,14 @@ float * network_predict_image(DarknetNetworkPtr ptr, const DarknetImage im)
 		// Input image is the same size as our net, predict on that image
 		p = network_predict(*net, im.data);
 	}
+	else if (im.c == net->c)
+	{
+		// resize the image directly into the network's input buffer instead of allocating a new image
+		Darknet::Image resized = {net->w, net->h, net->c, Darknet::network_input_buffer(*net)};
+		net->details->letterbox_source_size = cv::Size();
+		Darknet::resize_image_into(im, resized);
+		p = network_predict(*net, resized.data);
+	}
 	else
 	{
 		// need to resize image to the desired size for the net
@@ -1457,6 +1704,14 @@ float * network_predict_image_letterbox(DarknetNetworkPtr ptr, DarknetImage im)
 		// Input image is the same size as our net, predict on that image
 		p = network_predict(*net, im.data);
 	}
+	else if (im.c == net->c)
+	{
+		// letterbox the image directly into the network's input buffer instead of allocating a new image
+		Darknet::Image boxed = {net->w, net->h, net->c, Darknet::network_input_buffer(*net)};
+		net->details->letterbox_source_size = cv::Size();
+		Darknet::letterbox_image_into(im, net->w, net->h, boxed);
+		p = network_predict(*net, boxed.data);
+	}
 	else
 	{
 		// Need to resize image to the desired size for the net
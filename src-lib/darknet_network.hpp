@@ -9,6 +9,25 @@
 
 namespace Darknet
 {
+	class WorkerPool;
+
+	/** A label -- class name and confidence -- which has already been rendered, ready to be copied above a bounding
+	 * box by @ref Darknet::annotate().  The sprite is a little taller than the label itself so the descenders of the
+	 * text are not cut off, and the mask determines which pixels are copied.
+	 *
+	 * @see @ref Darknet::NetworkDetails::label_sprites
+	 *
+	 * @since 2026-10-18
+	 */
+	struct LabelSprite
+	{
+		cv::Mat		image;		///< The rendered label, same type as the annotated image.
+		cv::Mat		mask;		///< Non-zero where @ref image must be copied.
+		int			height;		///< Height of the label background, not including the descenders.
+		cv::Scalar	background;	///< The class colour used when the sprite was rendered.
+		cv::Scalar	foreground;	///< The text colour used when the sprite was rendered.
+	};
+
 	/** A place to store other details related to the neural network which we cannot easily add to the usual
 	 * @ref Darknet::Network structure.  These are typically C++ objects, or things added post %Darknet V3 (2024-08).
 	 *
@@ -132,6 +151,16 @@ namespace Darknet
 			 */
 			bool annotate_draw_label;
 
+			/** Labels which have already been rendered by @ref Darknet::annotate(), indexed by class, confidence
+			 * percentage, and OpenCV image type.  This is cleared when the font or line type changes.
+			 * @see @ref Darknet::set_annotation_font()
+			 * @since 2026-10-18
+			 */
+			std::map<std::tuple<int, int, int>, LabelSprite> label_sprites;
+
+			/// Protects @ref label_sprites, since images may be annotated from several threads at once.  @since 2026-10-18
+			std::mutex label_sprites_mutex;
+
 			/** Indexes of classes which Darknet should ignore.
 			 *
 			 * @ref Darknet::skipped_classes()
@@ -139,6 +168,99 @@ namespace Darknet
 			 * @since 2024-10-07
 			 */
 			SInt classes_to_ignore;
+
+			/** How images are resized to the network dimensions.
+			 * Default is @ref Darknet::EResizeMode::NEAREST.
+			 * @see @ref Darknet::set_resize_mode()
+			 * @since 2026-10-18
+			 */
+			Darknet::EResizeMode resize_mode;
+
+			/** Persistent buffer where images are written prior to calling the neural network.  This avoids allocating a
+			 * new image every time @ref Darknet::predict() is called.
+			 * @see @ref Darknet::get_input_buffer()
+			 * @since 2026-10-18
+			 */
+			VFloat input_buffer;
+
+			/** Size in bytes of the network workspace.  When @p random=1 resizes the network during training, the workspace
+			 * is only re-allocated if a larger one is needed.  Since the first batches are always at the largest size, the
+			 * workspace is normally allocated once.
+			 * @since 2026-10-18
+			 */
+			size_t workspace_capacity;
+
+			/** Size of the last image letterboxed into @ref input_buffer, and the network dimensions at the time.  When the
+			 * next image has the same size the grey border is already in place and does not need to be written again.
+			 * Anything else which writes to @ref input_buffer must reset these.
+			 * @since 2026-10-18
+			 */
+			cv::Size letterbox_source_size;
+			cv::Size letterbox_network_size;
+
+			/** When enabled, @ref Darknet::predict() splits large images into overlapping tiles so small objects are not
+			 * lost when the image is shrunk to the network dimensions.  Default is @p false.
+			 * @see @ref Darknet::set_tiled_inference()
+			 * @since 2026-10-18
+			 */
+			bool tiled_inference;
+
+			/** Size of each tile, in pixels of the original image.  An empty size means the network dimensions, in which
+			 * case the tiles are not resized.
+			 * @since 2026-10-18
+			 */
+			cv::Size tile_size;
+
+			/// How much adjacent tiles overlap, from @p 0.0 to @p 0.9.  Default is @p 0.2.  @since 2026-10-18
+			float tile_overlap;
+
+			/// Whether the whole image is also processed as one additional tile, to find large objects.  @since 2026-10-18
+			bool tile_full_frame;
+
+			/** Maximum number of CPU threads this network may use for each layer.  This is useful when several networks
+			 * run side-by-side in the same process, to prevent them from competing for the same cores.
+			 * Default is @p 0, meaning all the threads in the worker pool.
+			 * @see @ref Darknet::set_thread_budget()
+			 * @see @ref Darknet::WorkerPool
+			 * @since 2026-10-18
+			 */
+			size_t thread_budget;
+
+			/** When enabled, layers which do not depend on each other -- such as the two halves of a CSP block or the
+			 * multiple YOLO heads -- are run concurrently on the worker pool.  This only applies to CPU inference.
+			 * Default is @p false.
+			 * @see @ref Darknet::set_concurrent_branches()
+			 * @since 2026-10-18
+			 */
+			bool concurrent_branches;
+
+			/// @{ The layer dependency graph used when @ref concurrent_branches is enabled.  Built the first time it is needed.  @since 2026-10-18
+			std::vector<VInt> layer_dependents;
+			VInt layer_dependency_count;
+			size_t max_concurrent_layers;
+			/// @}
+
+			/** Extra workspaces so layers running at the same time don't overwrite each other's scratch memory.  The first
+			 * branch always uses @ref Darknet::Network::workspace.  @since 2026-10-18
+			 */
+			std::vector<std::vector<float>> branch_workspaces;
+
+			/** The NUMA node to which this network has been bound, or @p -1 if the network is not bound to a node.
+			 * @see @ref Darknet::bind_to_numa_node()
+			 * @since 2026-10-18
+			 */
+			int numa_node;
+
+			/** The worker pool used by this network.  When not set, the library-wide pool is used.
+			 * @see @ref Darknet::bind_to_numa_node()
+			 * @since 2026-10-18
+			 */
+			std::shared_ptr<Darknet::WorkerPool> worker_pool;
+
+			/// @{ Inference statistics used to calculate throughput.  @see @ref Darknet::numa_throughput()  @since 2026-10-18
+			std::atomic<uint64_t> images_processed;
+			std::atomic<uint64_t> inference_nanoseconds;
+			/// @}
 	};
 
 
@@ -290,6 +412,66 @@ namespace Darknet
 	};
 
 	char * detection_to_json(Darknet::Detection *dets, int nboxes, int classes, const Darknet::VStr & names, long long int frame_id, char *filename);
+
+	/** Convert a BGR or BGRA image into the planar RGB floats expected by the network, resizing it to the network
+	 * dimensions if necessary.  This is the "preprocessing" part of @ref Darknet::predict().  @p dst must have room for
+	 * the network width x height x channels floats, such as the buffer returned by @ref network_input_buffer().
+	 *
+	 * @since 2026-10-18
+	 */
+	void prepare_network_input(const Darknet::Network & net, const cv::Mat & mat, float * dst);
+
+	/** Get the persistent input buffer which belongs to the network.  The buffer is only re-allocated if the network
+	 * dimensions grow.  @see @ref Darknet::get_input_buffer()
+	 *
+	 * @since 2026-10-18
+	 */
+	float * network_input_buffer(Darknet::Network & net);
+
+	/** Get the raw detections once the network has run.  This takes into account the letterboxing done by
+	 * @ref prepare_network_input() when @ref Darknet::EResizeMode::LETTERBOX is used.  The detections must eventually be
+	 * freed, for example by calling @ref detections_to_predictions().
+	 *
+	 * @since 2026-10-18
+	 */
+	Darknet::Detection * get_network_detections(Darknet::Network & net, const cv::Size & original_image_size, int & nboxes);
+
+	/** Apply NMS to the detections returned by @ref get_network_boxes() and convert them to @ref Darknet::Predictions.
+	 * This is the "post-processing" part of @ref Darknet::predict().  The detections are freed prior to returning.
+	 *
+	 * @since 2026-10-18
+	 */
+	Darknet::Predictions detections_to_predictions(const Darknet::Network & net, Darknet::Detection * darknet_results, const int nboxes, const cv::Size & original_image_size);
+
+	/** Same as @ref get_network_detections(), but for one of the images in a batch.  Only @p YOLO and @p REGION output
+	 * layers are supported.
+	 *
+	 * @since 2026-10-18
+	 */
+	Darknet::Detection * get_network_detections_batch(Darknet::Network & net, const int batch_idx, const cv::Size & original_image_size, int & nboxes);
+
+	/** Run the network on several images, @p net.batch images at a time, and return the predictions for each image in
+	 * the same order as the images were given.
+	 *
+	 * @since 2026-10-18
+	 */
+	std::vector<Darknet::Predictions> predict_batch(Darknet::Network & net, const std::vector<cv::Mat> & mats);
+
+	/** Split an image into overlapping tiles.  The tiles are spread evenly, with the first and last tiles aligned to the
+	 * edges of the image, and adjacent tiles overlapping by at least @p overlap.
+	 *
+	 * @since 2026-10-18
+	 */
+	std::vector<cv::Rect> calculate_tiles(const cv::Size & image_size, const cv::Size & tile_size, const float overlap);
+
+	/** Run the network over overlapping tiles of the image and merge the results.  This is what @ref Darknet::predict()
+	 * calls when tiled inference is enabled.  Up to @p net.batch tiles are processed with each call to the network.
+	 *
+	 * @see @ref Darknet::set_tiled_inference()
+	 *
+	 * @since 2026-10-18
+	 */
+	Darknet::Predictions predict_tiles(Darknet::Network & net, const cv::Mat & mat);
 }
 
 
@@ -362,12 +544,15 @@ void ema_apply(Darknet::Network & net);
 void reject_similar_weights(Darknet::Network & net, float sim_threshold);
 
 float *network_predict(Darknet::Network & net, float *input);
+Darknet::Detection * make_network_boxes_batch(Darknet::Network * net, float thresh, int *num, int batch);
+void fill_network_boxes_batch(Darknet::Network * net, int w, int h, float thresh, float hier, int *map, int relative, Darknet::Detection *dets, int letter, int batch);
 det_num_pair* network_predict_batch(Darknet::Network *net, Darknet::Image im, int batch_size, int w, int h, float thresh, float hier, int *map, int relative, int letter);
 void free_batch_detections(det_num_pair *det_num_pairs, int n);
 void fuse_conv_batchnorm(Darknet::Network & net);
 
 float validate_detector_map(const char * datacfg, const char * cfgfile, const char * weightfile, float thresh_calc_avg_iou, const float iou_thresh, const int map_points, int letter_box, Darknet::Network *existing_net);
 void train_detector(const char *datacfg, const char *cfgfile, const char *weightfile, int *gpus, int ngpus, int clear, int dont_show, int calc_map, float thresh, float iou_thresh, int mjpeg_port, int show_imgs, int benchmark_layers, const char* chart_path);
+void loadbench_detector(const char * datacfg, const char * cfgfile);
 void test_detector(const char *datacfg, const char *cfgfile, const char *weightfile, const char *filename, float thresh, float hier_thresh, int dont_show, int ext_output, int save_labels, const char *outfile, int letter_box, int benchmark_layers);
 int network_width(Darknet::Network *net);
 int network_height(Darknet::Network *net);
@@ -0,0 +1,313 @@
+#include "darknet_internal.hpp"
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+
+namespace
+{
+	static auto & cfg_and_state = Darknet::CfgAndState::get();
+
+	static std::mutex numa_pools_mutex;
+	static std::map<int, std::weak_ptr<Darknet::WorkerPool>> numa_pools;
+
+	/// Parse a Linux CPU list such as @p "0-15,32-47".
+	static inline Darknet::VInt parse_cpu_list(const std::string & text)
+	{
+		TAT(TATPARMS);
+
+		Darknet::VInt cpus;
+
+		std::stringstream ss(text);
+		std::string range;
+		while (std::getline(ss, range, ','))
+		{
+			range = Darknet::trim(range);
+			if (range.empty())
+			{
+				continue;
+			}
+
+			const size_t pos = range.find('-');
+			const int first	= std::stoi(range.substr(0, pos));
+			const int last	= (pos == std::string::npos ? first : std::stoi(range.substr(pos + 1)));
+			for (int cpu = first; cpu <= last; cpu ++)
+			{
+				cpus.push_back(cpu);
+			}
+		}
+
+		return cpus;
+	}
+
+
+	static inline std::vector<Darknet::VInt> read_numa_topology()
+	{
+		TAT(TATPARMS);
+
+		std::vector<Darknet::VInt> nodes;
+
+		#ifdef WIN32
+		ULONG highest_node = 0;
+		if (GetNumaHighestNodeNumber(&highest_node))
+		{
+			for (ULONG node = 0; node <= highest_node; node ++)
+			{
+				ULONGLONG mask = 0;
+				Darknet::VInt cpus;
+				if (GetNumaNodeProcessorMask(static_cast<UCHAR>(node), &mask))
+				{
+					for (int cpu = 0; cpu < 64; cpu ++)
+					{
+						if (mask & (1ULL << cpu))
+						{
+							cpus.push_back(cpu);
+						}
+					}
+				}
+				if (not cpus.empty())
+				{
+					nodes.push_back(cpus);
+				}
+			}
+		}
+		#else
+		for (int node = 0; ; node ++)
+		{
+			const std::filesystem::path filename = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+			if (not std::filesystem::exists(filename))
+			{
+				break;
+			}
+
+			std::ifstream ifs(filename);
+			std::string line;
+			std::getline(ifs, line);
+			try
+			{
+				const auto cpus = parse_cpu_list(line);
+				if (not cpus.empty())
+				{
+					nodes.push_back(cpus);
+				}
+			}
+			catch (const std::exception &)
+			{
+				Darknet::display_warning_msg("failed to parse the list of CPUs for NUMA node #" + std::to_string(node) + ": \"" + line + "\"\n");
+			}
+		}
+		#endif
+
+		if (nodes.empty())
+		{
+			// not a NUMA computer, so pretend we have a single node with all the cores
+			Darknet::VInt cpus;
+			const int cores = std::max(1u, std::thread::hardware_concurrency());
+			for (int cpu = 0; cpu < cores; cpu ++)
+			{
+				cpus.push_back(cpu);
+			}
+			nodes.push_back(cpus);
+		}
+
+		return nodes;
+	}
+}
+
+
+const std::vector<Darknet::VInt> & Darknet::numa_nodes_and_cpus()
+{
+	TAT(TATPARMS);
+
+	static const std::vector<Darknet::VInt> nodes = read_numa_topology();
+
+	return nodes;
+}
+
+
+std::shared_ptr<Darknet::WorkerPool> Darknet::get_numa_node_pool(const int node)
+{
+	TAT(TATPARMS);
+
+	const auto & nodes = numa_nodes_and_cpus();
+	if (node < 0 or node >= static_cast<int>(nodes.size()))
+	{
+		throw std::invalid_argument("NUMA node #" + std::to_string(node) + " does not exist (valid range is 0-" + std::to_string(nodes.size() - 1) + ")");
+	}
+
+	std::scoped_lock lock(numa_pools_mutex);
+
+	auto pool = numa_pools[node].lock();
+	if (not pool)
+	{
+		// the first core is left for the thread which calls into Darknet, since it also does some of the work
+		const VInt & cpus = nodes[node];
+		const VInt worker_cpus(cpus.begin() + 1, cpus.end());
+
+		pool = std::make_shared<WorkerPool>(worker_cpus.size(), worker_cpus, "numa node " + std::to_string(node));
+		numa_pools[node] = pool;
+	}
+
+	return pool;
+}
+
+
+void Darknet::migrate_network_memory(Darknet::Network & net)
+{
+	TAT(TATPARMS);
+
+	if (cfg_and_state.gpu_index >= 0)
+	{
+		// weights and outputs live on the GPU, nothing to be gained by moving the CPU copies around
+		return;
+	}
+
+	std::map<float *, float *> moved;
+	const auto migrate = [&moved](float * ptr, const size_t count)
+	{
+		if (ptr == nullptr or count == 0 or moved.count(ptr))
+		{
+			return;
+		}
+
+		float * dst = static_cast<float *>(xcalloc(count, sizeof(float)));
+		std::memcpy(dst, ptr, count * sizeof(float));
+		moved[ptr] = dst;
+	};
+
+	size_t workspace_size = 0;
+	for (int idx = 0; idx < net.n; idx ++)
+	{
+		Darknet::Layer & l = net.layers[idx];
+		workspace_size = std::max(workspace_size, l.workspace_size);
+
+		if (l.type != Darknet::ELayerType::CONVOLUTIONAL)
+		{
+			continue;
+		}
+
+		if (l.share_layer == nullptr)
+		{
+			migrate(l.weights, l.nweights);
+			migrate(l.biases, l.n);
+			if (l.batch_normalize)
+			{
+				migrate(l.scales			, l.n);
+				migrate(l.rolling_mean		, l.n);
+				migrate(l.rolling_variance	, l.n);
+			}
+		}
+		migrate(l.output, static_cast<size_t>(l.outputs) * l.batch);
+	}
+
+	// resize_network() re-uses the workspace as long as it fits within the capacity, so all of it must be moved
+	workspace_size = std::max(workspace_size, net.details->workspace_capacity);
+	migrate(net.workspace, (workspace_size + sizeof(float) - 1) / sizeof(float));
+
+	// other layers may be pointing to the same memory (shared weights, dropout layers, etc.) so update every reference
+	const auto update = [&moved](float *& ptr)
+	{
+		const auto iter = moved.find(ptr);
+		if (iter != moved.end())
+		{
+			ptr = iter->second;
+		}
+	};
+	for (int idx = 0; idx < net.n; idx ++)
+	{
+		Darknet::Layer & l = net.layers[idx];
+		update(l.weights);
+		update(l.biases);
+		update(l.scales);
+		update(l.rolling_mean);
+		update(l.rolling_variance);
+		update(l.output);
+
+		// shortcut layers keep a copy of the output pointer for each layer they read, same as resize_shortcut_layer()
+		if (l.layers_output and l.input_layers)
+		{
+			for (int k = 0; k < l.n; k ++)
+			{
+				l.layers_output[k] = net.layers[l.input_layers[k]].output;
+			}
+		}
+	}
+	update(net.workspace);
+	update(net.output);
+
+	for (auto & [old_ptr, new_ptr] : moved)
+	{
+		free(old_ptr);
+	}
+
+	return;
+}
+
+
+size_t Darknet::numa_node_count()
+{
+	TAT(TATPARMS);
+
+	return numa_nodes_and_cpus().size();
+}
+
+
+void Darknet::bind_to_numa_node(Darknet::NetworkPtr ptr, const int node)
+{
+	TAT(TATPARMS);
+
+	Darknet::Network * net = reinterpret_cast<Darknet::Network*>(ptr);
+	if (net == nullptr)
+	{
+		throw std::invalid_argument("pointer to neural network cannot be NULL");
+	}
+
+	auto pool = get_numa_node_pool(node);
+
+	// from now on the calling thread only runs on this node, so the memory allocated below is local to the node
+	WorkerPool::pin_current_thread(numa_nodes_and_cpus().at(node));
+	migrate_network_memory(*net);
+
+	net->details->numa_node					= node;
+	net->details->worker_pool				= pool;
+	net->details->images_processed			= 0;
+	net->details->inference_nanoseconds		= 0;
+
+	if (cfg_and_state.is_verbose)
+	{
+		std::cout << "Neural network bound to NUMA node #" << node << " (" << numa_nodes_and_cpus().at(node).size() << " cores)" << std::endl;
+	}
+
+	return;
+}
+
+
+std::map<int, float> Darknet::numa_throughput(const std::vector<Darknet::NetworkPtr> & networks)
+{
+	TAT(TATPARMS);
+
+	std::map<int, float> images_per_second;
+
+	for (const auto & ptr : networks)
+	{
+		const Darknet::Network * net = reinterpret_cast<const Darknet::Network*>(ptr);
+		if (net == nullptr)
+		{
+			throw std::invalid_argument("pointer to neural network cannot be NULL");
+		}
+
+		const uint64_t images		= net->details->images_processed;
+		const uint64_t nanoseconds	= net->details->inference_nanoseconds;
+
+		// replicas on the same node run side-by-side, so their individual rates add up
+		float & rate = images_per_second[net->details->numa_node];
+		if (nanoseconds > 0)
+		{
+			rate += static_cast<float>(images) * 1000000000.0f / static_cast<float>(nanoseconds);
+		}
+	}
+
+	return images_per_second;
+}
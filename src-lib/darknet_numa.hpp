@@ -0,0 +1,36 @@
+/* Darknet/YOLO:  https://github.com/hank-ai/darknet
+ * Copyright 2024 Stephane Charette
+ */
+
+#pragma once
+
+#include "darknet_internal.hpp"
+
+/** @file
+ * NUMA topology and placement of neural networks on multi-socket computers.  @see @ref Darknet::bind_to_numa_node()
+ */
+
+
+namespace Darknet
+{
+	/** Get the list of logical cores which belong to each NUMA node.  On computers without NUMA (or where the topology
+	 * cannot be determined) this returns a single node which contains every core.  The topology is only read once.
+	 *
+	 * @since 2026-10-18
+	 */
+	const std::vector<VInt> & numa_nodes_and_cpus();
+
+	/** Get the worker pool for the given NUMA node.  The threads are pinned to the cores of that node.  All networks
+	 * bound to the same node share the same pool, which is destroyed once the last of those networks is freed.
+	 *
+	 * @since 2026-10-18
+	 */
+	std::shared_ptr<WorkerPool> get_numa_node_pool(const int node);
+
+	/** Re-allocate the weights and the layer outputs of the network from the calling thread.  Linux and Windows both use
+	 * a "first-touch" policy, so when the calling thread is pinned to a NUMA node the new memory is local to that node.
+	 *
+	 * @since 2026-10-18
+	 */
+	void migrate_network_memory(Darknet::Network & net);
+}
@@ -0,0 +1,361 @@
+/* Darknet/YOLO:  https://github.com/hank-ai/darknet
+ * Copyright 2024 Stephane Charette
+ */
+
+#pragma once
+
+#ifndef __cplusplus
+#error "The Darknet/YOLO project requires a C++ compiler."
+#endif
+
+/** @file
+ * This file defines @ref Darknet::BoundedQueue, a fixed-size queue used to pass work items between threads.
+ */
+
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+
+namespace Darknet
+{
+	/** A bounded multi-producer multi-consumer FIFO queue built on a lock-free ring buffer.  Works equally well when
+	 * there is a single producer and a single consumer.
+	 *
+	 * Pushing and popping never takes a lock.  The blocking calls @ref push() and @ref pop() only fall back to a
+	 * mutex and condition variable when they must sleep because the queue is full (back-pressure on the producer)
+	 * or empty (consumer is starved).  This replaces the common pattern of polling a mutex-protected container with
+	 * @p std::this_thread::sleep_for().
+	 *
+	 * Once @ref close() has been called, pushing new items fails but consumers can continue to pop what remains in the
+	 * queue.  @ref pop() returns @p false once the queue is both closed and empty, which is how consumer threads know
+	 * they can exit.
+	 *
+	 * The ring buffer algorithm is Dmitry Vyukov's bounded MPMC queue.
+	 *
+	 * @since 2026-10-18
+	 */
+	template <typename T>
+	class BoundedQueue final
+	{
+		public:
+
+			BoundedQueue() = delete;
+			BoundedQueue(const BoundedQueue &) = delete;
+			BoundedQueue & operator=(const BoundedQueue &) = delete;
+
+			/** Create a queue which can hold at least @p minimum_capacity items.  The capacity is rounded up to the
+			 * next power of 2.
+			 *
+			 * @since 2026-10-18
+			 */
+			explicit BoundedQueue(const size_t minimum_capacity) :
+				mask(round_up_to_power_of_2(minimum_capacity) - 1),
+				cells(new Cell[mask + 1]),
+				enqueue_position(0),
+				dequeue_position(0),
+				closed(false),
+				producers_active(0),
+				producers_waiting(0),
+				consumers_waiting(0)
+			{
+				for (size_t idx = 0; idx <= mask; idx ++)
+				{
+					cells[idx].sequence.store(idx, std::memory_order_relaxed);
+				}
+			}
+
+			/// Destructor.
+			~BoundedQueue() = default;
+
+			/** Attempt to add an item to the queue without blocking.  Returns @p false if the queue is full or has been
+			 * closed, in which case @p item is left untouched.
+			 *
+			 * @since 2026-10-18
+			 */
+			bool try_push(T && item)
+			{
+				// close() and pop() wait for this counter to drop to zero, so an item is never left half-published
+				producers_active.fetch_add(1, std::memory_order_seq_cst);
+				if (closed.load(std::memory_order_seq_cst))
+				{
+					producers_active.fetch_sub(1, std::memory_order_release);
+					return false;
+				}
+
+				Cell * cell = nullptr;
+				size_t position = enqueue_position.load(std::memory_order_relaxed);
+				while (true)
+				{
+					cell = &cells[position & mask];
+					const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+					const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+					if (difference == 0)
+					{
+						if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						{
+							break;
+						}
+					}
+					else if (difference < 0)
+					{
+						// the queue is full
+						producers_active.fetch_sub(1, std::memory_order_release);
+						return false;
+					}
+					else
+					{
+						position = enqueue_position.load(std::memory_order_relaxed);
+					}
+				}
+
+				cell->item = std::move(item);
+				cell->sequence.store(position + 1, std::memory_order_release);
+				producers_active.fetch_sub(1, std::memory_order_release);
+
+				wake(consumers_waiting, not_empty);
+
+				return true;
+			}
+
+			/// Copy the item into the queue.  @see @ref try_push()
+			bool try_push(const T & item)
+			{
+				T tmp(item);
+				return try_push(std::move(tmp));
+			}
+
+			/** Attempt to remove the oldest item from the queue without blocking.  Returns @p false if the queue is
+			 * empty.
+			 *
+			 * @since 2026-10-18
+			 */
+			bool try_pop(T & item)
+			{
+				Cell * cell = nullptr;
+				size_t position = dequeue_position.load(std::memory_order_relaxed);
+				while (true)
+				{
+					cell = &cells[position & mask];
+					const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+					const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+					if (difference == 0)
+					{
+						if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						{
+							break;
+						}
+					}
+					else if (difference < 0)
+					{
+						// the queue is empty
+						return false;
+					}
+					else
+					{
+						position = dequeue_position.load(std::memory_order_relaxed);
+					}
+				}
+
+				item = std::move(cell->item);
+				cell->sequence.store(position + mask + 1, std::memory_order_release);
+
+				wake(producers_waiting, not_full);
+
+				return true;
+			}
+
+			/** Add an item to the queue, blocking while the queue is full.  Returns @p false if the queue has been
+			 * closed, in which case the item was not added.
+			 *
+			 * @since 2026-10-18
+			 */
+			bool push(T && item)
+			{
+				while (true)
+				{
+					if (try_push(std::move(item)))
+					{
+						return true;
+					}
+
+					if (closed.load(std::memory_order_acquire))
+					{
+						return false;
+					}
+
+					std::unique_lock lock(mtx);
+					producers_waiting ++;
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+					not_full.wait(lock, [&]{ return can_push() or closed.load(std::memory_order_acquire); });
+					producers_waiting --;
+				}
+			}
+
+			/// Copy the item into the queue.  @see @ref push()
+			bool push(const T & item)
+			{
+				T tmp(item);
+				return push(std::move(tmp));
+			}
+
+			/** Remove the oldest item from the queue, blocking while the queue is empty.  Returns @p false once the
+			 * queue has been closed and there are no items left.
+			 *
+			 * @since 2026-10-18
+			 */
+			bool pop(T & item)
+			{
+				while (true)
+				{
+					if (try_pop(item))
+					{
+						return true;
+					}
+
+					if (closed.load(std::memory_order_seq_cst))
+					{
+						// a producer may have snuck in one last item before the queue was closed
+						wait_for_producers();
+						return try_pop(item);
+					}
+
+					std::unique_lock lock(mtx);
+					consumers_waiting ++;
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+					not_empty.wait(lock, [&]{ return can_pop() or closed.load(std::memory_order_acquire); });
+					consumers_waiting --;
+				}
+			}
+
+			/** Close the queue.  New items can no longer be added, and all blocked threads are woken up.  Items which
+			 * were being pushed at the same time are finished before this returns, so they are not lost.
+			 *
+			 * @since 2026-10-18
+			 */
+			void close()
+			{
+				closed.store(true, std::memory_order_seq_cst);
+				wait_for_producers();
+
+				std::scoped_lock lock(mtx);
+				not_full.notify_all();
+				not_empty.notify_all();
+
+				return;
+			}
+
+			/// Determine if @ref close() has been called.  @since 2026-10-18
+			bool is_closed() const
+			{
+				return closed.load(std::memory_order_acquire);
+			}
+
+			/** Approximate number of items in the queue.  Since other threads may be pushing or popping, this is only
+			 * a snapshot.
+			 *
+			 * @since 2026-10-18
+			 */
+			size_t size() const
+			{
+				const size_t tail = dequeue_position.load(std::memory_order_acquire);
+				const size_t head = enqueue_position.load(std::memory_order_acquire);
+
+				return head > tail ? head - tail : 0;
+			}
+
+			/// Determine if the queue is empty.  This is a snapshot.  @since 2026-10-18
+			bool empty() const
+			{
+				return size() == 0;
+			}
+
+			/// The maximum number of items the queue can hold.  @since 2026-10-18
+			size_t capacity() const
+			{
+				return mask + 1;
+			}
+
+		private:
+
+			struct Cell
+			{
+				std::atomic<size_t> sequence;
+				T item;
+			};
+
+			static size_t round_up_to_power_of_2(const size_t value)
+			{
+				size_t result = 2;
+				while (result < value)
+				{
+					result <<= 1;
+				}
+
+				return result;
+			}
+
+			/// Returns @p true if the next cell is free, or if another producer got to it first and we need to try again.
+			bool can_push() const
+			{
+				const size_t position = enqueue_position.load(std::memory_order_relaxed);
+				const size_t sequence = cells[position & mask].sequence.load(std::memory_order_acquire);
+
+				return static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position) >= 0;
+			}
+
+			/// Returns @p true if the next cell has an item, or if another consumer got to it first and we need to try again.
+			bool can_pop() const
+			{
+				const size_t position = dequeue_position.load(std::memory_order_relaxed);
+				const size_t sequence = cells[position & mask].sequence.load(std::memory_order_acquire);
+
+				return static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1) >= 0;
+			}
+
+			/** Wait for producers which have already claimed a cell to finish writing their item.  This only ever waits
+			 * for a few instructions, so there is no need to sleep.
+			 */
+			void wait_for_producers() const
+			{
+				while (producers_active.load(std::memory_order_acquire) > 0)
+				{
+					std::this_thread::yield();
+				}
+
+				return;
+			}
+
+			/// Only take the mutex if someone is actually asleep waiting for the state of the queue to change.
+			void wake(std::atomic<size_t> & waiting, std::condition_variable & cv)
+			{
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if (waiting.load(std::memory_order_relaxed) > 0)
+				{
+					std::scoped_lock lock(mtx);
+					cv.notify_all();
+				}
+
+				return;
+			}
+
+			const size_t mask;
+			std::unique_ptr<Cell[]> cells;
+
+			// keep the producer and consumer positions on different cache lines
+			alignas(64) std::atomic<size_t> enqueue_position;
+			alignas(64) std::atomic<size_t> dequeue_position;
+			alignas(64) std::atomic<bool> closed;
+
+			std::atomic<size_t>		producers_active;	///< producers currently inside @ref try_push()
+			std::atomic<size_t>		producers_waiting;
+			std::atomic<size_t>		consumers_waiting;
+			std::mutex				mtx;
+			std::condition_variable	not_full;
+			std::condition_variable	not_empty;
+	};
+}
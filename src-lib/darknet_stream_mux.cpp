@@ -0,0 +1,486 @@
+#include "darknet_internal.hpp"
+#include "darknet_stream_mux.hpp"
+
+
+namespace
+{
+	static auto & cfg_and_state = Darknet::CfgAndState::get();
+
+	/// Prefix used to request a generated test pattern instead of a real video source.
+	const std::string test_pattern_prefix = "testpattern";
+}
+
+
+Darknet::StreamMux::StreamMux(const Darknet::NetworkPtr ptr, const size_t decoder_threads, const size_t frames_per_stream, const EDropPolicy policy) :
+	network_ptr(ptr),
+	number_of_decoder_threads(decoder_threads),
+	max_frames_per_stream(std::max<size_t>(1, frames_per_stream)),
+	drop_policy(policy),
+	streams_finished(0),
+	inference_finished(false),
+	running(false),
+	stopping(false)
+{
+	TAT(TATPARMS);
+
+	if (network_ptr == nullptr)
+	{
+		throw std::invalid_argument("cannot create stream mux without a network pointer");
+	}
+
+	return;
+}
+
+
+Darknet::StreamMux::~StreamMux()
+{
+	TAT(TATPARMS);
+
+	stop();
+
+	return;
+}
+
+
+size_t Darknet::StreamMux::add_stream(const std::string & source)
+{
+	TAT(TATPARMS);
+
+	if (running)
+	{
+		throw std::logic_error("cannot add a stream once the stream mux has started");
+	}
+
+	auto stream = std::make_unique<Stream>();
+	stream->source = source;
+
+	if (source.find(test_pattern_prefix) == 0)
+	{
+		// optional dimensions and frame rate, such as "testpattern:1280x720@30"
+		stream->is_test_pattern = true;
+		int w = 0;
+		int h = 0;
+		double fps = 0.0;
+		const int fields = std::sscanf(source.c_str() + test_pattern_prefix.size(), ":%dx%d@%lf", &w, &h, &fps);
+		if (fields >= 2 and w > 0 and h > 0)
+		{
+			stream->pattern_size = cv::Size(w, h);
+		}
+		if (fields == 3 and fps > 0.0)
+		{
+			stream->pattern_fps = fps;
+		}
+	}
+	else
+	{
+		stream->cap.open(source);
+		if (not stream->cap.isOpened())
+		{
+			throw std::invalid_argument("failed to open the video stream \"" + source + "\"");
+		}
+	}
+
+	streams.push_back(std::move(stream));
+
+	return streams.size() - 1;
+}
+
+
+void Darknet::StreamMux::start()
+{
+	TAT(TATPARMS);
+
+	if (running)
+	{
+		return;
+	}
+	if (streams.empty())
+	{
+		throw std::logic_error("cannot start the stream mux without any streams");
+	}
+
+	running = true;
+
+	size_t threads = number_of_decoder_threads;
+	if (threads == 0)
+	{
+		threads = std::clamp<size_t>(std::thread::hardware_concurrency() / 2, 1, streams.size());
+	}
+	threads = std::min(threads, streams.size());
+
+	const auto now = std::chrono::steady_clock::now();
+	for (auto & stream : streams)
+	{
+		stream->next_frame = now;
+	}
+
+	for (size_t idx = 0; idx < threads; idx ++)
+	{
+		decoders.emplace_back(&StreamMux::decoder_thread, this, idx);
+	}
+	inference = std::thread(&StreamMux::inference_thread, this);
+
+	return;
+}
+
+
+void Darknet::StreamMux::stop()
+{
+	TAT(TATPARMS);
+
+	if (true)
+	{
+		std::scoped_lock lock(mtx);
+		stopping = true;
+		frame_available.notify_all();
+		stream_available.notify_all();
+		space_available.notify_all();
+		result_available.notify_all();
+	}
+
+	for (auto & decoder : decoders)
+	{
+		if (decoder.joinable())
+		{
+			decoder.join();
+		}
+	}
+	decoders.clear();
+
+	if (inference.joinable())
+	{
+		inference.join();
+	}
+
+	return;
+}
+
+
+size_t Darknet::StreamMux::number_of_streams() const
+{
+	TAT(TATPARMS);
+
+	return streams.size();
+}
+
+
+size_t Darknet::StreamMux::frames_dropped(const size_t stream_index) const
+{
+	TAT(TATPARMS);
+
+	return streams.at(stream_index)->dropped.load();
+}
+
+
+bool Darknet::StreamMux::get_result(StreamResult & result)
+{
+	TAT(TATPARMS);
+
+	std::unique_lock lock(mtx);
+	result_available.wait(lock, [&]{ return not results.empty() or inference_finished or stopping; });
+
+	if (exception)
+	{
+		std::rethrow_exception(exception);
+	}
+
+	if (results.empty())
+	{
+		return false;
+	}
+
+	result = std::move(results.front());
+	results.pop_front();
+
+	// the inference thread may be waiting for room to store more results
+	space_available.notify_all();
+
+	return true;
+}
+
+
+cv::Mat Darknet::StreamMux::read_frame(Stream & stream)
+{
+	TAT(TATPARMS);
+
+	cv::Mat frame;
+
+	if (not stream.is_test_pattern)
+	{
+		stream.cap.read(frame);
+		return frame;
+	}
+
+	const int w = stream.pattern_size.width;
+	const int h = stream.pattern_size.height;
+	frame = cv::Mat(stream.pattern_size, CV_8UC3, cv::Scalar(64, 64, 64));
+
+	// a few shapes moving across the frame so motion-based code has something to look at
+	const int x = static_cast<int>(stream.frame_number * 4) % w;
+	const int y = static_cast<int>(stream.frame_number * 2) % h;
+	cv::rectangle(frame, cv::Rect(x, h / 4, w / 8, h / 4), cv::Scalar(0, 0, 255), cv::FILLED);
+	cv::circle(frame, cv::Point(w - x, y), std::max(4, h / 10), cv::Scalar(0, 255, 0), cv::FILLED);
+	cv::putText(frame, stream.source + " #" + std::to_string(stream.frame_number), cv::Point(10, h - 10), cv::FONT_HERSHEY_SIMPLEX, 0.75, cv::Scalar(255, 255, 255), 2);
+
+	return frame;
+}
+
+
+size_t Darknet::StreamMux::find_ready_stream(std::chrono::steady_clock::time_point & earliest) const
+{
+	TAT(TATPARMS);
+
+	const auto now = std::chrono::steady_clock::now();
+	earliest = std::chrono::steady_clock::time_point::max();
+	size_t ready = streams.size();
+
+	for (size_t idx = 0; idx < streams.size(); idx ++)
+	{
+		const Stream & stream = *streams[idx];
+		if (stream.busy or stream.finished)
+		{
+			continue;
+		}
+
+		if (drop_policy == EDropPolicy::BLOCK and stream.frames.size() >= max_frames_per_stream)
+		{
+			// nothing to do until the inference thread takes some frames, which will wake us up
+			continue;
+		}
+
+		// if several streams are ready, pick the one which has been waiting the longest
+		if (stream.next_frame <= now)
+		{
+			if (ready == streams.size() or stream.next_frame < streams[ready]->next_frame)
+			{
+				ready = idx;
+			}
+		}
+		else
+		{
+			earliest = std::min(earliest, stream.next_frame);
+		}
+	}
+
+	return ready;
+}
+
+
+void Darknet::StreamMux::decoder_thread(const size_t thread_idx)
+{
+	TAT(TATPARMS);
+
+	cfg_and_state.set_thread_name("stream mux decoder #" + std::to_string(thread_idx));
+
+	/* The decoder threads are a shared pool.  Each time a thread is idle it claims whichever stream has a frame due,
+	 * reads one frame, and then releases the stream.  A stream which stalls (such as a RTSP camera which stops sending
+	 * frames) only ties up the one thread reading it, and the test patterns use a deadline per stream instead of
+	 * sleeping, so many of them can share a single thread and still run at the requested frame rate.
+	 */
+
+	std::unique_lock lock(mtx);
+
+	while (not stopping and streams_finished < streams.size())
+	{
+		std::chrono::steady_clock::time_point earliest;
+		const size_t stream_index = find_ready_stream(earliest);
+		if (stream_index == streams.size())
+		{
+			if (earliest == std::chrono::steady_clock::time_point::max())
+			{
+				stream_available.wait(lock);
+			}
+			else
+			{
+				stream_available.wait_until(lock, earliest);
+			}
+			continue;
+		}
+
+		Stream & stream = *streams[stream_index];
+		stream.busy = true;
+
+		StreamResult item;
+		item.stream_index	= stream_index;
+		item.frame_number	= stream.frame_number;
+
+		// decoding can take a while (or block for a long time on a network stream) so it is done without the lock
+		lock.unlock();
+		item.frame			= read_frame(stream);
+		item.timestamp		= std::chrono::high_resolution_clock::now();
+		item.position_ms	= stream.is_test_pattern ? 1000.0 * stream.frame_number / stream.pattern_fps : stream.cap.get(cv::CAP_PROP_POS_MSEC);
+		stream.frame_number ++;
+		lock.lock();
+
+		stream.busy = false;
+
+		if (stream.is_test_pattern)
+		{
+			// a test pattern runs in real time like a camera would, otherwise it would only measure how fast we can draw
+			const auto frame_duration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / stream.pattern_fps));
+			const auto now = std::chrono::steady_clock::now();
+			stream.next_frame += frame_duration;
+			if (stream.next_frame + frame_duration < now)
+			{
+				// we've fallen behind; skip ahead rather than generating a burst of frames to catch up
+				stream.next_frame = now;
+			}
+		}
+		else
+		{
+			// a real stream is ready again right away since the capture itself waits for the frames, but this places it
+			// behind the other streams which are ready so the threads go around all the streams in turn
+			stream.next_frame = std::chrono::steady_clock::now();
+		}
+
+		if (stopping)
+		{
+			break;
+		}
+
+		if (item.frame.empty())
+		{
+			stream.finished = true;
+			streams_finished ++;
+			frame_available.notify_all();
+			stream_available.notify_all();
+			continue;
+		}
+
+		if (stream.frames.size() >= max_frames_per_stream)
+		{
+			// with EDropPolicy::BLOCK this cannot happen, since find_ready_stream() only returns streams which have room
+			if (drop_policy == EDropPolicy::DROP_NEWEST)
+			{
+				stream.dropped ++;
+				stream_available.notify_one();
+				continue;
+			}
+
+			stream.frames.pop_front();
+			stream.dropped ++;
+		}
+
+		stream.frames.push_back(std::move(item));
+		frame_available.notify_all();
+
+		// another decoder may be waiting for this stream to be released
+		stream_available.notify_one();
+	}
+
+	lock.unlock();
+
+	cfg_and_state.del_thread_name();
+
+	return;
+}
+
+
+void Darknet::StreamMux::inference_thread()
+{
+	TAT(TATPARMS);
+
+	cfg_and_state.set_thread_name("stream mux inference");
+
+	if (cfg_and_state.gpu_index >= 0)
+	{
+		// the active GPU is a per-thread setting
+		cuda_set_device(cfg_and_state.gpu_index);
+	}
+
+	Darknet::Network & net = *reinterpret_cast<Darknet::Network *>(network_ptr);
+	const size_t batch_size		= std::max(1, net.batch);
+	const size_t max_results	= streams.size() * max_frames_per_stream * 2;
+
+	size_t next_stream = 0;
+	while (true)
+	{
+		std::vector<StreamResult> batch;
+
+		if (true)
+		{
+			std::unique_lock lock(mtx);
+
+			const auto frames_are_waiting = [&]()
+			{
+				for (const auto & stream : streams)
+				{
+					if (not stream->frames.empty())
+					{
+						return true;
+					}
+				}
+				return false;
+			};
+
+			frame_available.wait(lock, [&]{ return stopping or streams_finished == streams.size() or frames_are_waiting(); });
+			if (stopping or not frames_are_waiting())
+			{
+				break;
+			}
+
+			// take 1 frame from each stream in turn so a busy stream cannot starve the others
+			while (batch.size() < batch_size and frames_are_waiting())
+			{
+				auto & frames = streams[next_stream]->frames;
+				if (not frames.empty())
+				{
+					batch.push_back(std::move(frames.front()));
+					frames.pop_front();
+				}
+				next_stream = (next_stream + 1) % streams.size();
+			}
+
+			space_available.notify_all();
+			stream_available.notify_all();
+		}
+
+		std::vector<cv::Mat> mats;
+		for (const auto & item : batch)
+		{
+			mats.push_back(item.frame);
+		}
+
+		std::vector<Darknet::Predictions> predictions;
+		try
+		{
+			predictions = Darknet::predict_batch(net, mats);
+		}
+		catch (...)
+		{
+			// give the exception to the caller, and shut everything down
+			std::scoped_lock lock(mtx);
+			exception = std::current_exception();
+			stopping = true;
+			frame_available.notify_all();
+			stream_available.notify_all();
+			space_available.notify_all();
+			break;
+		}
+
+		std::unique_lock lock(mtx);
+		for (size_t idx = 0; idx < batch.size(); idx ++)
+		{
+			space_available.wait(lock, [&]{ return results.size() < max_results or stopping; });
+			if (stopping)
+			{
+				break;
+			}
+
+			batch[idx].predictions = std::move(predictions[idx]);
+			results.push_back(std::move(batch[idx]));
+			result_available.notify_all();
+		}
+	}
+
+	if (true)
+	{
+		std::scoped_lock lock(mtx);
+		inference_finished = true;
+		result_available.notify_all();
+	}
+
+	cfg_and_state.del_thread_name();
+
+	return;
+}
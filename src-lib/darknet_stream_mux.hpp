@@ -0,0 +1,186 @@
+/* Darknet/YOLO:  https://github.com/hank-ai/darknet
+ * Copyright 2024 Stephane Charette
+ */
+
+#pragma once
+
+#ifndef __cplusplus
+#error "The Darknet/YOLO project requires a C++ compiler."
+#endif
+
+/** @file
+ * This file defines @ref Darknet::StreamMux, which runs a single neural network on many video streams at once.
+ */
+
+
+#include "darknet.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+
+namespace Darknet
+{
+	/** What @ref Darknet::StreamMux does with a new frame when the neural network has fallen behind and the queue for
+	 * that stream is full.
+	 *
+	 * @since 2026-10-18
+	 */
+	enum class EDropPolicy
+	{
+		BLOCK		,	///< stop decoding the stream until there is room; no frames are lost (best for video files)
+		DROP_OLDEST	,	///< discard the oldest queued frame to make room; results stay current (best for live cameras)
+		DROP_NEWEST	,	///< discard the new frame
+	};
+
+	/** One decoded frame and its predictions, as returned by @ref Darknet::StreamMux::get_result().
+	 *
+	 * @since 2026-10-18
+	 */
+	struct StreamResult
+	{
+		size_t stream_index = 0;	///< Index returned by @ref Darknet::StreamMux::add_stream().
+		size_t frame_number = 0;	///< Zero-based frame number within this stream, including frames which were dropped.
+		double position_ms = 0.0;	///< Position of the frame within the video, from @p cv::CAP_PROP_POS_MSEC.
+		std::chrono::high_resolution_clock::time_point timestamp;	///< When the frame was decoded.
+		cv::Mat frame;				///< The decoded BGR frame.
+		Predictions predictions;	///< The objects found in this frame.
+	};
+
+	/** The @p %StreamMux class ("stream multiplexer") decodes many video streams on a shared set of decoder threads,
+	 * and feeds the frames from all the streams to a single neural network.  Streams are not tied to a thread:  an idle
+	 * decoder thread picks up whichever stream has a frame due, so one slow or stalled stream does not hold up the
+	 * others.  When the network was loaded with a batch
+	 * size larger than 1, frames from different streams are combined into the same batch.  The predictions are then
+	 * returned per stream, in the order in which the frames were decoded.
+	 *
+	 * Each stream has a small queue of decoded frames.  When the network cannot keep up, the @ref EDropPolicy decides
+	 * what happens to new frames.
+	 *
+	 * Sources can be anything @p cv::VideoCapture accepts, such as video files or RTSP URLs.  The special source
+	 * @p "testpattern" (or @p "testpattern:1280x720@30") generates a moving test pattern without any camera, which is
+	 * useful to measure throughput.
+	 *
+	 * @code
+	 * Darknet::StreamMux mux(net);
+	 * mux.add_stream("rtsp://camera1/stream");
+	 * mux.add_stream("rtsp://camera2/stream");
+	 * mux.start();
+	 *
+	 * Darknet::StreamResult result;
+	 * while (mux.get_result(result))
+	 * {
+	 *     std::cout << "stream #" << result.stream_index << " frame #" << result.frame_number << ": " << result.predictions << std::endl;
+	 * }
+	 * @endcode
+	 *
+	 * @warning Only the inference thread touches the neural network, so the network pointer must not be used with
+	 * @ref Darknet::predict() or any other inference call while the @p %StreamMux is running.
+	 *
+	 * @since 2026-10-18
+	 */
+	class StreamMux final
+	{
+		public:
+
+			StreamMux() = delete;
+			StreamMux(const StreamMux &) = delete;
+			StreamMux & operator=(const StreamMux &) = delete;
+
+			/** Constructor needs a neural network pointer.  @see @ref Darknet::load_neural_network()
+			 *
+			 * @param [in] decoder_threads Number of threads used to decode the streams.  Zero means one thread per
+			 * stream, up to half the number of CPU cores.
+			 * @param [in] frames_per_stream Maximum number of decoded frames waiting for the network, per stream.
+			 * @param [in] policy What to do with new frames once a stream's queue is full.
+			 *
+			 * @since 2026-10-18
+			 */
+			StreamMux(const Darknet::NetworkPtr ptr, const size_t decoder_threads = 0, const size_t frames_per_stream = 2, const EDropPolicy policy = EDropPolicy::DROP_OLDEST);
+
+			/// Destructor.  Stops all the threads.  Frames which have not yet been processed are discarded.
+			~StreamMux();
+
+			/** Add a video file, a stream URL, or a test pattern.  This must be called before @ref start().  Returns the
+			 * index used to identify this stream in @ref Darknet::StreamResult::stream_index.
+			 *
+			 * @since 2026-10-18
+			 */
+			size_t add_stream(const std::string & source);
+
+			/// Start decoding and processing all the streams.  @since 2026-10-18
+			void start();
+
+			/// Stop decoding.  Blocked calls to @ref get_result() return @p false.  @since 2026-10-18
+			void stop();
+
+			/** Wait for the next processed frame from any of the streams.  Returns @p false once all the streams have
+			 * ended (or @ref stop() was called) and every remaining frame has been returned.  If the neural network
+			 * threw an exception, it is re-thrown here.
+			 *
+			 * @since 2026-10-18
+			 */
+			bool get_result(StreamResult & result);
+
+			/// The number of streams added with @ref add_stream().  @since 2026-10-18
+			size_t number_of_streams() const;
+
+			/// The number of frames from this stream which were discarded because of the @ref EDropPolicy.  @since 2026-10-18
+			size_t frames_dropped(const size_t stream_index) const;
+
+		private:
+
+			struct Stream
+			{
+				std::string					source;
+				cv::VideoCapture			cap;
+				bool						is_test_pattern	= false;
+				cv::Size					pattern_size	= cv::Size(640, 480);
+				double						pattern_fps		= 30.0;
+				size_t						frame_number	= 0;
+				bool						finished		= false;	///< protected by @ref StreamMux::mtx
+				bool						busy			= false;	///< a decoder thread is reading from this stream; protected by @ref StreamMux::mtx
+				std::chrono::steady_clock::time_point next_frame;		///< when the next frame is due; protected by @ref StreamMux::mtx
+				std::atomic<size_t>			dropped			= 0;
+				std::deque<StreamResult>	frames;			///< protected by @ref StreamMux::mtx
+			};
+
+			/// Read the next frame from this stream, or return an empty frame at the end of the stream.
+			cv::Mat read_frame(Stream & stream);
+
+			/** Find a stream which is not being read by another thread and which has a frame due.  Returns the index of
+			 * the stream, or @p streams.size() if none are ready, in which case @p earliest is set to the next time one
+			 * of the streams will be ready.  Must be called while holding @ref mtx.
+			 */
+			size_t find_ready_stream(std::chrono::steady_clock::time_point & earliest) const;
+
+			void decoder_thread(const size_t thread_idx);
+			void inference_thread();
+
+			const Darknet::NetworkPtr network_ptr;
+			const size_t number_of_decoder_threads;
+			const size_t max_frames_per_stream;
+			const EDropPolicy drop_policy;
+
+			std::vector<std::unique_ptr<Stream>> streams;
+
+			/// Protects the frame queue of each stream, and the results.
+			std::mutex mtx;
+			std::condition_variable frame_available;
+			std::condition_variable stream_available;	///< wakes up the decoder threads
+			std::condition_variable space_available;
+			std::condition_variable result_available;
+
+			std::deque<StreamResult> results;
+			std::exception_ptr exception;
+			size_t streams_finished;
+			bool inference_finished;
+			bool running;
+			bool stopping;
+
+			std::vector<std::thread> decoders;
+			std::thread inference;
+	};
+}
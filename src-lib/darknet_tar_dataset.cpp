@@ -0,0 +1,565 @@
+#include "darknet_internal.hpp"
+
+
+namespace
+{
+	static auto & cfg_and_state = Darknet::CfgAndState::get();
+
+	/// Every member in a tar file starts with a header of this size, and the content is padded to a multiple of it.
+	static const size_t tar_block_size = 512;
+
+	/// Files are read in chunks of this size, so the shards are accessed sequentially in large reads.
+	static const size_t tar_read_buffer_size = 4 * 1024 * 1024;
+
+	/// File extensions which are treated as images within a shard.
+	static const Darknet::SStr tar_image_extensions = {"jpg", "jpeg", "png", "bmp", "tif", "tiff", "webp"};
+
+	/// One image and its annotations, as read from a shard.
+	struct StreamedSample
+	{
+		std::string						name;	///< shard filename followed by the name of the image within the shard
+		std::vector<uint8_t>			image;	///< encoded image, such as the content of a JPEG file
+		std::vector<Darknet::PackedBox>	boxes;
+	};
+
+	using StreamedSamplePtr = std::shared_ptr<StreamedSample>;
+
+	/// A file in a shard.
+	struct TarMember
+	{
+		std::string				name;
+		std::vector<uint8_t>	content;
+	};
+
+
+	/// @{ State shared by the shard reading thread and the image loading threads.  Protected by @ref tar_mutex.
+	static std::mutex tar_mutex;
+	static std::condition_variable tar_sample_available;
+	static std::condition_variable tar_space_available;
+	static std::vector<StreamedSamplePtr> tar_shuffle_buffer;
+	static size_t tar_shuffle_buffer_size = 0;
+	static bool tar_reader_must_exit = false;
+	/// @}
+
+	/// @{ Set by @ref Darknet::open_streaming_dataset() before the shard reading thread is started.
+	static std::vector<std::filesystem::path> tar_shards;
+	static std::atomic<size_t> tar_number_of_images = 0;
+	static uint64_t tar_seed = 0;
+	static std::thread tar_reader_thread;
+	/// @}
+
+	/// The images given to each image loading thread by the most recent call to @ref Darknet::get_streamed_paths().
+	static thread_local std::map<std::string, StreamedSamplePtr> tar_current_samples;
+
+
+	/// Parse an octal number from a tar header, such as the size of the member.
+	static inline uint64_t tar_octal(const char * field, const size_t len)
+	{
+		TAT(TATPARMS);
+
+		uint64_t value = 0;
+		for (size_t idx = 0; idx < len and field[idx] >= '0' and field[idx] <= '7'; idx ++)
+		{
+			value = value * 8 + (field[idx] - '0');
+		}
+
+		return value;
+	}
+
+
+	/// Get a string from a tar header field, which is not necessarily terminated.
+	static inline std::string tar_string(const char * field, const size_t len)
+	{
+		TAT(TATPARMS);
+
+		return std::string(field, strnlen(field, len));
+	}
+
+
+	/// Read the regular files in a tar file one at a time, from beginning to end.
+	class TarReader final
+	{
+		public:
+
+			TarReader(const std::filesystem::path & fn) :
+				filename(fn),
+				buffer(tar_read_buffer_size)
+			{
+				ifs.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+				ifs.open(filename, std::ios::binary);
+				return;
+			}
+
+			bool good() const
+			{
+				return ifs.good();
+			}
+
+			/** Get the next regular file in the tar.  Returns @p false at the end of the archive.  The content is only
+			 * read if @p read_content is set, otherwise it is skipped which is much faster when only counting images.
+			 */
+			bool next(TarMember & member, const bool read_content)
+			{
+				TAT(TATPARMS);
+
+				std::string long_name;
+
+				while (true)
+				{
+					char header[tar_block_size];
+					if (not ifs.read(header, sizeof(header)))
+					{
+						return false;
+					}
+
+					if (header[0] == '\0')
+					{
+						// an empty block marks the end of the archive
+						return false;
+					}
+
+					const uint64_t size		= tar_octal(header + 124, 12);
+					const char type			= header[156];
+					const uint64_t padded	= (size + tar_block_size - 1) / tar_block_size * tar_block_size;
+
+					if (type == 'L' or type == 'x')
+					{
+						// GNU long name, or a POSIX extended header which may contain the name of the next member
+						std::string content(padded, '\0');
+						if (not ifs.read(content.data(), padded))
+						{
+							return false;
+						}
+						content.resize(size);
+
+						if (type == 'L')
+						{
+							long_name = content.c_str();
+						}
+						else
+						{
+							// each record looks like "<length> <key>=<value>\n"
+							size_t pos = 0;
+							while (pos < content.size())
+							{
+								const size_t space = content.find(' ', pos);
+								const size_t length = std::atol(content.c_str() + pos);
+								if (space == std::string::npos or length == 0)
+								{
+									break;
+								}
+								const std::string record = content.substr(space + 1, length - (space + 1 - pos) - 1);
+								if (record.find("path=") == 0)
+								{
+									long_name = record.substr(5);
+								}
+								pos += length;
+							}
+						}
+						continue;
+					}
+
+					if (type != '0' and type != '\0')
+					{
+						// directories, links, etc.
+						ifs.seekg(padded, std::ios::cur);
+						continue;
+					}
+
+					if (long_name.empty())
+					{
+						const std::string prefix = tar_string(header + 345, 155);
+						member.name = tar_string(header, 100);
+						if (not prefix.empty() and std::memcmp(header + 257, "ustar", 5) == 0)
+						{
+							member.name = prefix + "/" + member.name;
+						}
+					}
+					else
+					{
+						member.name = long_name;
+					}
+
+					if (read_content)
+					{
+						member.content.resize(size);
+						if (not ifs.read(reinterpret_cast<char *>(member.content.data()), size))
+						{
+							return false;
+						}
+						ifs.seekg(padded - size, std::ios::cur);
+					}
+					else
+					{
+						member.content.clear();
+						ifs.seekg(padded, std::ios::cur);
+					}
+
+					return true;
+				}
+			}
+
+		private:
+
+			std::filesystem::path	filename;
+			std::vector<char>		buffer;
+			std::ifstream			ifs;
+	};
+
+
+	/** WebDataset groups the members using everything up to the first dot in the filename, so @p "a/b.c.jpg" has the
+	 * key @p "a/b" and the extension @p "c.jpg".
+	 */
+	static inline void split_member_name(const std::string & name, std::string & key, std::string & extension)
+	{
+		TAT(TATPARMS);
+
+		const size_t slash = name.rfind('/');
+		const size_t dot = name.find('.', (slash == std::string::npos ? 0 : slash + 1));
+
+		key = name.substr(0, dot);
+		extension = (dot == std::string::npos ? "" : Darknet::lowercase(name.substr(dot + 1)));
+
+		return;
+	}
+
+
+	static inline bool is_image_extension(const std::string & extension)
+	{
+		TAT(TATPARMS);
+
+		// only look at the last part of the extension, "c.jpg" is an image
+		const size_t dot = extension.rfind('.');
+
+		return tar_image_extensions.count(dot == std::string::npos ? extension : extension.substr(dot + 1)) > 0;
+	}
+
+
+	/// Parse the content of an annotation file.  Each line is the class, and the normalized center, width, and height.
+	static inline std::vector<Darknet::PackedBox> parse_annotations(const std::vector<uint8_t> & content)
+	{
+		TAT(TATPARMS);
+
+		std::vector<Darknet::PackedBox> boxes;
+
+		std::istringstream iss(std::string(content.begin(), content.end()));
+		Darknet::PackedBox box;
+		while (iss >> box.id >> box.x >> box.y >> box.w >> box.h)
+		{
+			boxes.push_back(box);
+		}
+
+		return boxes;
+	}
+
+
+	/// Add a sample to the shuffle buffer, waiting for space if the buffer is full.
+	static inline bool add_to_shuffle_buffer(StreamedSamplePtr sample)
+	{
+		TAT(TATPARMS);
+
+		std::unique_lock lock(tar_mutex);
+		tar_space_available.wait(lock, [](){ return tar_reader_must_exit or tar_shuffle_buffer.size() < tar_shuffle_buffer_size; });
+
+		if (tar_reader_must_exit)
+		{
+			return false;
+		}
+
+		tar_shuffle_buffer.push_back(sample);
+		tar_sample_available.notify_all();
+
+		return true;
+	}
+
+
+	/// Read one shard from beginning to end, passing each image to the shuffle buffer.
+	static inline bool stream_shard(const std::filesystem::path & shard, size_t & images_read)
+	{
+		TAT(TATPARMS);
+
+		TarReader reader(shard);
+		if (not reader.good())
+		{
+			Darknet::display_warning_msg("Failed to open the shard " + shard.string() + ".\n");
+			return true;
+		}
+
+		StreamedSamplePtr sample;
+		std::string sample_key;
+		TarMember member;
+
+		const auto flush = [&]()
+		{
+			bool ok = true;
+			if (sample and not sample->image.empty())
+			{
+				// images without annotations are negative samples
+				ok = add_to_shuffle_buffer(sample);
+				images_read ++;
+			}
+			sample.reset();
+			return ok;
+		};
+
+		while (reader.next(member, true))
+		{
+			std::string key;
+			std::string extension;
+			split_member_name(member.name, key, extension);
+
+			if (not sample or key != sample_key)
+			{
+				if (not flush())
+				{
+					return false;
+				}
+				sample = std::make_shared<StreamedSample>();
+				sample_key = key;
+			}
+
+			if (is_image_extension(extension))
+			{
+				sample->name = shard.string() + "/" + member.name;
+				sample->image.swap(member.content);
+			}
+			else if (extension == "txt")
+			{
+				sample->boxes = parse_annotations(member.content);
+			}
+		}
+
+		return flush();
+	}
+
+
+	/// This runs on a secondary thread until the dataset is closed, reading all the shards once per epoch.
+	static void tar_reader_loop()
+	{
+		TAT(TATPARMS);
+
+		cfg_and_state.set_thread_name("tar shard reader");
+
+		std::vector<size_t> order(tar_shards.size());
+		std::iota(order.begin(), order.end(), 0);
+
+		for (uint64_t epoch = 0; true; epoch ++)
+		{
+			// shuffle the shards differently every epoch, but in a way that can be reproduced with the same seed
+			set_rng_stream(tar_seed, epoch);
+			for (size_t idx = order.size() - 1; idx > 0; idx --)
+			{
+				std::swap(order[idx], order[random_gen(0, idx)]);
+			}
+			clear_rng_stream();
+
+			size_t images_read = 0;
+			for (const auto idx : order)
+			{
+				if (not stream_shard(tar_shards[idx], images_read))
+				{
+					cfg_and_state.del_thread_name();
+					return;
+				}
+			}
+
+			if (images_read == 0)
+			{
+				darknet_fatal_error(DARKNET_LOC, "failed to read any images from the .tar shards");
+			}
+		}
+	}
+}
+
+
+bool Darknet::open_streaming_dataset(const std::filesystem::path & train_filename, const uint64_t seed, const size_t shuffle_buffer_size)
+{
+	TAT(TATPARMS);
+
+	close_streaming_dataset();
+
+	list * plist = get_paths(train_filename.string().c_str());
+	char ** paths = (char **)list_to_array(plist);
+	std::vector<std::filesystem::path> shards;
+	for (int idx = 0; idx < plist->size; idx ++)
+	{
+		std::filesystem::path path = paths[idx];
+		if (Darknet::lowercase(path.extension().string()) == ".tar")
+		{
+			shards.push_back(path);
+		}
+	}
+	const int number_of_paths = plist->size;
+	free(paths);
+	free_list_contents(plist);
+	free_list(plist);
+
+	if (shards.empty())
+	{
+		return false;
+	}
+
+	if (shards.size() != static_cast<size_t>(number_of_paths))
+	{
+		darknet_fatal_error(DARKNET_LOC, "%s contains both .tar shards and images", train_filename.string().c_str());
+	}
+
+	// count the images -- only the headers are read, the rest of the content is skipped
+	std::vector<size_t> images_per_shard(shards.size(), 0);
+	Darknet::parallel_for(0, static_cast<int>(shards.size()), [&](const int idx)
+	{
+		TarReader reader(shards[idx]);
+		TarMember member;
+		std::string key;
+		std::string extension;
+		while (reader.next(member, false))
+		{
+			split_member_name(member.name, key, extension);
+			if (is_image_extension(extension))
+			{
+				images_per_shard[idx] ++;
+			}
+		}
+	});
+
+	tar_number_of_images = std::accumulate(images_per_shard.begin(), images_per_shard.end(), size_t(0));
+	if (tar_number_of_images == 0)
+	{
+		darknet_fatal_error(DARKNET_LOC, "no images found in the .tar shards listed in %s", train_filename.string().c_str());
+	}
+
+	std::cout
+		<< "Streaming " << tar_number_of_images << " images from " << shards.size() << " shards"
+		<< " (shuffle buffer is " << std::max<size_t>(1, shuffle_buffer_size) << " images)." << std::endl;
+
+	tar_shards					= shards;
+	tar_seed					= seed;
+	tar_shuffle_buffer_size		= std::max<size_t>(1, shuffle_buffer_size);
+	tar_reader_must_exit		= false;
+	tar_reader_thread			= std::thread(tar_reader_loop);
+
+	return true;
+}
+
+
+void Darknet::close_streaming_dataset()
+{
+	TAT(TATPARMS);
+
+	if (true)
+	{
+		std::scoped_lock lock(tar_mutex);
+		tar_reader_must_exit = true;
+	}
+	tar_space_available.notify_all();
+	tar_sample_available.notify_all();
+
+	if (tar_reader_thread.joinable())
+	{
+		tar_reader_thread.join();
+	}
+
+	std::scoped_lock lock(tar_mutex);
+	tar_shuffle_buffer.clear();
+	tar_shards.clear();
+	tar_number_of_images = 0;
+
+	return;
+}
+
+
+bool Darknet::is_streaming_dataset_open()
+{
+	TAT(TATPARMS);
+
+	return tar_number_of_images > 0;
+}
+
+
+size_t Darknet::streaming_dataset_size()
+{
+	TAT(TATPARMS);
+
+	return tar_number_of_images;
+}
+
+
+char ** Darknet::get_streamed_paths(const int n, const int contrastive)
+{
+	TAT(TATPARMS);
+
+	tar_current_samples.clear();
+
+	char ** random_paths = (char **)xcalloc(n, sizeof(char *));
+
+	std::unique_lock lock(tar_mutex);
+
+	for (int i = 0; i < n; ++i)
+	{
+		if (contrastive and (i % 2 == 1))
+		{
+			random_paths[i] = random_paths[i - 1];
+			continue;
+		}
+
+		// keep the buffer at least half full so there is always a good mix of images to choose from
+		const size_t minimum = std::max<size_t>(1, tar_shuffle_buffer_size / 2);
+		tar_sample_available.wait(lock, [&](){ return tar_reader_must_exit or tar_shuffle_buffer.size() >= minimum; });
+		if (tar_shuffle_buffer.empty())
+		{
+			darknet_fatal_error(DARKNET_LOC, "the streaming dataset was closed while images were still needed");
+		}
+
+		const size_t index = random_gen(0, tar_shuffle_buffer.size() - 1);
+		std::swap(tar_shuffle_buffer[index], tar_shuffle_buffer.back());
+		StreamedSamplePtr sample = tar_shuffle_buffer.back();
+		tar_shuffle_buffer.pop_back();
+
+		// the same image can be picked more than once when the buffer holds several epochs of a small dataset
+		const auto result = tar_current_samples.insert_or_assign(sample->name, sample);
+		random_paths[i] = const_cast<char *>(result.first->first.c_str());
+	}
+
+	tar_space_available.notify_all();
+
+	return random_paths;
+}
+
+
+cv::Mat Darknet::get_streamed_image(const char * filename, const int channels)
+{
+	TAT(TATPARMS);
+
+	const auto iter = tar_current_samples.find(filename);
+	if (iter == tar_current_samples.end())
+	{
+		return cv::Mat();
+	}
+
+	return decode_rgb_mat_image(iter->second->image, channels, filename);
+}
+
+
+const Darknet::PackedBox * Darknet::get_streamed_boxes(const char * filename, int & count)
+{
+	TAT(TATPARMS);
+
+	count = 0;
+
+	const auto iter = tar_current_samples.find(filename);
+	if (iter == tar_current_samples.end())
+	{
+		return nullptr;
+	}
+
+	// images without any objects must still return a valid pointer, otherwise the caller looks for a .txt file
+	static const Darknet::PackedBox no_boxes = {};
+	if (iter->second->boxes.empty())
+	{
+		return &no_boxes;
+	}
+
+	count = iter->second->boxes.size();
+
+	return iter->second->boxes.data();
+}
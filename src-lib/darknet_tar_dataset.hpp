@@ -0,0 +1,63 @@
+/* Darknet/YOLO:  https://github.com/hank-ai/darknet
+ * Copyright 2024 Stephane Charette
+ */
+
+#pragma once
+
+#include "darknet_internal.hpp"
+
+/** @file
+ * Streaming training datasets.  Instead of listing every image in @p train=..., the list can contain the names of
+ * @p .tar files ("shards") in the WebDataset layout:  each image is stored next to its @p .txt annotations, and both
+ * members share the same name up to the first dot, such as @p 000123.jpg and @p 000123.txt.
+ *
+ * The shards are read sequentially in a random order, and the images go through an in-memory shuffle buffer before
+ * they are used for training.  This way a dataset can be stored as a few hundred large files instead of millions of
+ * small ones.
+ *
+ * @see @ref Darknet::open_streaming_dataset()
+ */
+
+
+namespace Darknet
+{
+	/** If the list of training images contains @p .tar shards, start reading them on a secondary thread.  Returns
+	 * @p false if this is a normal list of images.  The order of the shards is shuffled every epoch using @p seed.
+	 * Up to @p shuffle_buffer_size images are kept in memory to randomize the order of the images.
+	 *
+	 * @since 2026-10-18
+	 */
+	bool open_streaming_dataset(const std::filesystem::path & train_filename, const uint64_t seed, const size_t shuffle_buffer_size);
+
+	/// Stop reading the shards opened by @ref open_streaming_dataset().  @since 2026-10-18
+	void close_streaming_dataset();
+
+	/// Determine if @ref open_streaming_dataset() was called and found some shards.  @since 2026-10-18
+	bool is_streaming_dataset_open();
+
+	/// The total number of images in all the shards.  @since 2026-10-18
+	size_t streaming_dataset_size();
+
+	/** Take @p n random images from the shuffle buffer.  The returned array must be freed by the caller, but not the
+	 * names it contains.  The images and annotations can then be obtained with @ref get_streamed_image() and
+	 * @ref get_streamed_boxes() from the same thread, until the next time this is called.  When @p contrastive is set,
+	 * each image is returned twice in a row just like @ref get_random_paths_custom().
+	 *
+	 * @since 2026-10-18
+	 */
+	char ** get_streamed_paths(const int n, const int contrastive);
+
+	/** Decode one of the images returned by the last call to @ref get_streamed_paths() on this thread.  The image is
+	 * RGB (or greyscale when @p channels is @p 1).  Returns an empty image if this is not a streamed image.
+	 *
+	 * @since 2026-10-18
+	 */
+	cv::Mat get_streamed_image(const char * filename, const int channels);
+
+	/** Get the annotations for one of the images returned by the last call to @ref get_streamed_paths() on this thread.
+	 * Returns @p nullptr if this is not a streamed image.
+	 *
+	 * @since 2026-10-18
+	 */
+	const PackedBox * get_streamed_boxes(const char * filename, int & count);
+}
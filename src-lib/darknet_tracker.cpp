@@ -0,0 +1,326 @@
+#include "darknet_internal.hpp"
+#include "darknet_tracker.hpp"
+
+
+namespace
+{
+	/// Number of points tracked across each object, in both directions.  A 4x4 grid gives 16 points per object.
+	constexpr int points_per_side = 4;
+
+	/// Points where the forward and backward optical flow disagree by more than this many pixels are not trusted.
+	constexpr float maximum_forward_backward_error = 1.5f;
+
+	static inline cv::Mat to_grey(const cv::Mat & mat)
+	{
+		TAT(TATPARMS);
+
+		cv::Mat grey;
+		if (mat.channels() == 3)
+		{
+			cv::cvtColor(mat, grey, cv::COLOR_BGR2GRAY);
+		}
+		else if (mat.channels() == 4)
+		{
+			cv::cvtColor(mat, grey, cv::COLOR_BGRA2GRAY);
+		}
+		else
+		{
+			grey = mat.clone();
+		}
+
+		return grey;
+	}
+}
+
+
+Darknet::TrackedPredictor::TrackedPredictor(const Darknet::NetworkPtr ptr, const size_t interval) :
+	network_ptr(ptr),
+	keyframe_interval(std::max<size_t>(1, interval)),
+	minimum_tracking_confidence(0.5f),
+	match_threshold(0.3f),
+	next_track_id(1),
+	frames_since_keyframe(0),
+	keyframe(false),
+	keyframe_counter(0),
+	tracked_counter(0)
+{
+	TAT(TATPARMS);
+
+	if (network_ptr == nullptr)
+	{
+		throw std::invalid_argument("cannot create tracked predictor without a network pointer");
+	}
+
+	return;
+}
+
+
+Darknet::TrackedPredictor::~TrackedPredictor()
+{
+	TAT(TATPARMS);
+
+	return;
+}
+
+
+Darknet::TrackedPredictor & Darknet::TrackedPredictor::set_keyframe_interval(const size_t frames)
+{
+	TAT(TATPARMS);
+
+	if (frames < 1)
+	{
+		throw std::invalid_argument("keyframe interval must be at least 1");
+	}
+
+	keyframe_interval = frames;
+
+	return *this;
+}
+
+
+Darknet::TrackedPredictor & Darknet::TrackedPredictor::set_minimum_tracking_confidence(const float confidence)
+{
+	TAT(TATPARMS);
+
+	if (confidence < 0.0f or confidence > 1.0f)
+	{
+		throw std::invalid_argument("tracking confidence must be between 0.0 and 1.0");
+	}
+
+	minimum_tracking_confidence = confidence;
+
+	return *this;
+}
+
+
+Darknet::TrackedPredictor & Darknet::TrackedPredictor::set_match_threshold(const float iou_threshold)
+{
+	TAT(TATPARMS);
+
+	if (iou_threshold <= 0.0f or iou_threshold > 1.0f)
+	{
+		throw std::invalid_argument("match threshold must be greater than 0.0 and no more than 1.0");
+	}
+
+	match_threshold = iou_threshold;
+
+	return *this;
+}
+
+
+Darknet::TrackedPredictor & Darknet::TrackedPredictor::reset()
+{
+	TAT(TATPARMS);
+
+	previous_grey.release();
+	tracks.clear();
+	frames_since_keyframe = 0;
+
+	return *this;
+}
+
+
+bool Darknet::TrackedPredictor::last_frame_was_keyframe() const
+{
+	TAT(TATPARMS);
+
+	return keyframe;
+}
+
+
+size_t Darknet::TrackedPredictor::keyframes() const
+{
+	TAT(TATPARMS);
+
+	return keyframe_counter;
+}
+
+
+size_t Darknet::TrackedPredictor::tracked_frames() const
+{
+	TAT(TATPARMS);
+
+	return tracked_counter;
+}
+
+
+Darknet::Predictions Darknet::TrackedPredictor::predict(const cv::Mat & mat)
+{
+	TAT(TATPARMS);
+
+	if (mat.empty())
+	{
+		throw std::invalid_argument("cannot predict without a valid image");
+	}
+
+	frames_since_keyframe ++;
+
+	const bool must_run_network =
+			previous_grey.empty()							or
+			previous_grey.size() != mat.size()				or
+			frames_since_keyframe >= keyframe_interval;
+
+	if (not must_run_network and track(mat))
+	{
+		keyframe = false;
+		tracked_counter ++;
+		return tracks;
+	}
+
+	keyframe = true;
+	keyframe_counter ++;
+	frames_since_keyframe = 0;
+
+	return detect(mat);
+}
+
+
+Darknet::Predictions Darknet::TrackedPredictor::detect(const cv::Mat & mat)
+{
+	TAT(TATPARMS);
+
+	Predictions predictions = Darknet::predict(network_ptr, mat);
+
+	/* Greedy matching:  consider every (prediction, track) pair of the same class, best IoU first.  Each prediction
+	 * inherits the ID of the track it matches, and predictions which don't match anything start a new track.  Tracks
+	 * which don't match any of the new predictions are dropped.
+	 */
+	struct Candidate
+	{
+		float	iou;
+		size_t	prediction_idx;
+		size_t	track_idx;
+	};
+	std::vector<Candidate> candidates;
+	for (size_t prediction_idx = 0; prediction_idx < predictions.size(); prediction_idx ++)
+	{
+		for (size_t track_idx = 0; track_idx < tracks.size(); track_idx ++)
+		{
+			if (predictions[prediction_idx].best_class != tracks[track_idx].best_class)
+			{
+				continue;
+			}
+
+			const float overlap = Darknet::iou(predictions[prediction_idx].rect, tracks[track_idx].rect);
+			if (overlap >= match_threshold)
+			{
+				candidates.push_back({overlap, prediction_idx, track_idx});
+			}
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(),
+		[](const Candidate & lhs, const Candidate & rhs)
+		{
+			return lhs.iou > rhs.iou;
+		});
+
+	std::vector<bool> track_is_used(tracks.size(), false);
+	for (const auto & candidate : candidates)
+	{
+		auto & pred = predictions[candidate.prediction_idx];
+		if (pred.track_id == 0 and not track_is_used[candidate.track_idx])
+		{
+			pred.track_id = tracks[candidate.track_idx].track_id;
+			track_is_used[candidate.track_idx] = true;
+		}
+	}
+
+	for (auto & pred : predictions)
+	{
+		if (pred.track_id == 0)
+		{
+			pred.track_id = next_track_id ++;
+		}
+	}
+
+	tracks = predictions;
+	previous_grey = to_grey(mat);
+
+	return tracks;
+}
+
+
+bool Darknet::TrackedPredictor::track(const cv::Mat & mat)
+{
+	TAT(TATPARMS);
+
+	cv::Mat grey = to_grey(mat);
+
+	if (tracks.empty())
+	{
+		previous_grey = grey;
+		return true;
+	}
+
+	// sample a grid of points inside each object, staying away from the edges which are often background
+	std::vector<cv::Point2f> previous_points;
+	previous_points.reserve(tracks.size() * points_per_side * points_per_side);
+	for (const auto & pred : tracks)
+	{
+		for (int y = 0; y < points_per_side; y ++)
+		{
+			for (int x = 0; x < points_per_side; x ++)
+			{
+				previous_points.emplace_back(
+					pred.rect.x + pred.rect.width	* (0.25f + 0.5f * (x + 0.5f) / points_per_side),
+					pred.rect.y + pred.rect.height	* (0.25f + 0.5f * (y + 0.5f) / points_per_side));
+			}
+		}
+	}
+
+	// track forward and then backward, so points which don't come back to where they started can be rejected
+	std::vector<cv::Point2f> current_points;
+	std::vector<cv::Point2f> backward_points;
+	std::vector<uint8_t> forward_status;
+	std::vector<uint8_t> backward_status;
+	std::vector<float> error;
+	cv::calcOpticalFlowPyrLK(previous_grey, grey, previous_points, current_points, forward_status, error);
+	cv::calcOpticalFlowPyrLK(grey, previous_grey, current_points, backward_points, backward_status, error);
+
+	const float width	= mat.cols;
+	const float height	= mat.rows;
+	const size_t points_per_track = points_per_side * points_per_side;
+
+	Predictions moved = tracks;
+	for (size_t track_idx = 0; track_idx < moved.size(); track_idx ++)
+	{
+		std::vector<float> dx;
+		std::vector<float> dy;
+		for (size_t point_idx = track_idx * points_per_track; point_idx < (track_idx + 1) * points_per_track; point_idx ++)
+		{
+			if (forward_status[point_idx] and backward_status[point_idx] and
+				cv::norm(backward_points[point_idx] - previous_points[point_idx]) <= maximum_forward_backward_error)
+			{
+				dx.push_back(current_points[point_idx].x - previous_points[point_idx].x);
+				dy.push_back(current_points[point_idx].y - previous_points[point_idx].y);
+			}
+		}
+
+		const float confidence = static_cast<float>(dx.size()) / points_per_track;
+		if (dx.empty() or confidence < minimum_tracking_confidence)
+		{
+			// this object cannot be followed reliably, the caller needs to run the neural network
+			return false;
+		}
+
+		// the median ignores the few points which landed on the background
+		std::nth_element(dx.begin(), dx.begin() + dx.size() / 2, dx.end());
+		std::nth_element(dy.begin(), dy.begin() + dy.size() / 2, dy.end());
+
+		auto & pred = moved[track_idx];
+		pred.rect.x += cvRound(dx[dx.size() / 2]);
+		pred.rect.y += cvRound(dy[dy.size() / 2]);
+		pred.normalized_point = cv::Point2f((pred.rect.x + pred.rect.width / 2.0f) / width, (pred.rect.y + pred.rect.height / 2.0f) / height);
+
+		if ((pred.rect & cv::Rect(0, 0, mat.cols, mat.rows)).area() == 0)
+		{
+			// the object has left the frame
+			return false;
+		}
+	}
+
+	tracks = moved;
+	previous_grey = grey;
+
+	return true;
+}
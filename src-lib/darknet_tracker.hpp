@@ -0,0 +1,130 @@
+/* Darknet/YOLO:  https://github.com/hank-ai/darknet
+ * Copyright 2024 Stephane Charette
+ */
+
+#pragma once
+
+#ifndef __cplusplus
+#error "The Darknet/YOLO project requires a C++ compiler."
+#endif
+
+/** @file
+ * This file defines @ref Darknet::TrackedPredictor, which only runs the neural network on some video frames and tracks
+ * the objects in between.
+ */
+
+
+#include "darknet.hpp"
+
+
+namespace Darknet
+{
+	/** The @p %TrackedPredictor class runs the neural network on "keyframes" only.  On the frames in between, the
+	 * bounding boxes from the previous frame are moved using sparse optical flow, which is much cheaper than running
+	 * the network.  Every object is given a track ID (see @ref Darknet::Prediction::track_id) which remains the same for
+	 * as long as the object is being tracked.
+	 *
+	 * The network is called when:
+	 *
+	 * @li @ref set_keyframe_interval() frames have elapsed since the last time the network ran,
+	 * @li the optical flow cannot follow one of the objects with enough confidence, or
+	 * @li the frame size changes.
+	 *
+	 * On keyframes, the new predictions are matched to the existing tracks by IoU so the track IDs carry over.
+	 *
+	 * @code
+	 * Darknet::TrackedPredictor tracked_predictor(net, 5);
+	 * while (cap.read(frame))
+	 * {
+	 *     const auto predictions = tracked_predictor.predict(frame);
+	 *     // ...
+	 * }
+	 * @endcode
+	 *
+	 * @since 2026-10-18
+	 */
+	class TrackedPredictor final
+	{
+		public:
+
+			TrackedPredictor() = delete;
+			TrackedPredictor(const TrackedPredictor &) = delete;
+			TrackedPredictor & operator=(const TrackedPredictor &) = delete;
+
+			/** Constructor needs a neural network pointer.  @see @ref Darknet::load_neural_network()
+			 *
+			 * @p keyframe_interval is how often the neural network is called.  For example, @p 5 means the network runs
+			 * on 1 frame out of every 5, and the objects are tracked on the other 4 frames.
+			 *
+			 * @since 2026-10-18
+			 */
+			TrackedPredictor(const Darknet::NetworkPtr ptr, const size_t keyframe_interval = 5);
+
+			/// Destructor.
+			~TrackedPredictor();
+
+			/** Get the predictions for this video frame, either from the neural network or by tracking the objects found
+			 * in the previous frame.  @see @ref last_frame_was_keyframe()
+			 *
+			 * @since 2026-10-18
+			 */
+			Predictions predict(const cv::Mat & mat);
+
+			/// Run the neural network once every @p frames frames.  Must be at least @p 1.  @since 2026-10-18
+			TrackedPredictor & set_keyframe_interval(const size_t frames);
+
+			/** When less than this fraction of the points on an object can be followed by the optical flow, the tracking
+			 * is no longer trusted and the neural network is called.  Default is @p 0.5.
+			 *
+			 * @since 2026-10-18
+			 */
+			TrackedPredictor & set_minimum_tracking_confidence(const float confidence);
+
+			/** Minimum IoU between a new prediction and an existing track for both to be considered the same object.
+			 * Default is @p 0.3.
+			 *
+			 * @since 2026-10-18
+			 */
+			TrackedPredictor & set_match_threshold(const float iou_threshold);
+
+			/// Forget all the tracks.  The next frame is always a keyframe.  @since 2026-10-18
+			TrackedPredictor & reset();
+
+			/// Whether the neural network was called for the most recent frame.  @since 2026-10-18
+			bool last_frame_was_keyframe() const;
+
+			/// Number of frames where the neural network was called.  @since 2026-10-18
+			size_t keyframes() const;
+
+			/// Number of frames where the objects were tracked without calling the neural network.  @since 2026-10-18
+			size_t tracked_frames() const;
+
+		private:
+
+			/// Run the neural network and match the predictions to the existing tracks.
+			Predictions detect(const cv::Mat & mat);
+
+			/** Move the existing tracks using optical flow.  Returns @p false if one of the tracks could not be
+			 * followed, in which case the caller should run the network instead.
+			 */
+			bool track(const cv::Mat & mat);
+
+			const Darknet::NetworkPtr network_ptr;
+
+			size_t keyframe_interval;
+			float minimum_tracking_confidence;
+			float match_threshold;
+
+			/// Greyscale version of the previous frame, needed for the optical flow.
+			cv::Mat previous_grey;
+
+			/// The objects currently being tracked.  Each one has a unique @ref Darknet::Prediction::track_id.
+			Predictions tracks;
+
+			size_t next_track_id;
+			size_t frames_since_keyframe;
+			bool keyframe;
+			size_t keyframe_counter;
+			size_t tracked_counter;
+	};
+}
@@ -0,0 +1,477 @@
+#include "darknet_internal.hpp"
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+namespace
+{
+	static auto & cfg_and_state = Darknet::CfgAndState::get();
+
+	static std::mutex global_pool_mutex;
+	static std::unique_ptr<Darknet::WorkerPool> global_pool;
+
+	/// Pool to use on this thread.  When set to @p nullptr the library-wide pool is used.
+	static thread_local Darknet::WorkerPool * current_pool = nullptr;
+
+	/// Maximum number of threads to use on this thread.  Zero means no limit.
+	static thread_local size_t current_thread_budget = 0;
+
+	/// How many times an idle thread checks for more work before going to sleep.
+	constexpr int spin_count = 200;
+
+	static inline size_t default_number_of_workers()
+	{
+		TAT(TATPARMS);
+
+		const size_t cores = std::thread::hardware_concurrency();
+
+		// the thread which calls parallel_for() also does work, so we need 1 less worker than the number of cores
+		return cores > 1 ? cores - 1 : 0;
+	}
+}
+
+
+Darknet::WorkerPool::Scope::Scope(WorkerPool * pool, const size_t budget) :
+	previous_pool(current_pool),
+	previous_budget(current_thread_budget)
+{
+	TAT(TATPARMS);
+
+	current_pool			= pool;
+	current_thread_budget	= budget;
+
+	return;
+}
+
+
+Darknet::WorkerPool::Scope::~Scope()
+{
+	TAT(TATPARMS);
+
+	current_pool			= previous_pool;
+	current_thread_budget	= previous_budget;
+
+	return;
+}
+
+
+Darknet::WorkerPool::WorkerPool(const size_t number_of_workers, const VInt & cpus, const std::string & name) :
+	pool_name(name),
+	next_worker(0),
+	pending(0),
+	stop(false)
+{
+	TAT(TATPARMS);
+
+	workers.reserve(number_of_workers);
+	for (size_t idx = 0; idx < number_of_workers; idx ++)
+	{
+		workers.push_back(std::make_unique<Worker>());
+	}
+
+	// only start the threads once all the workers exist, since they will immediately try to steal from each other
+	for (size_t idx = 0; idx < number_of_workers; idx ++)
+	{
+		const int cpu = cpus.empty() ? -1 : cpus[idx % cpus.size()];
+		workers[idx]->thread = std::thread(&WorkerPool::worker_loop, this, idx, cpu);
+	}
+
+	return;
+}
+
+
+Darknet::WorkerPool::~WorkerPool()
+{
+	TAT(TATPARMS);
+
+	stop = true;
+	if (true)
+	{
+		std::scoped_lock lock(sleep_mtx);
+		sleep_cv.notify_all();
+	}
+
+	for (auto & worker : workers)
+	{
+		if (worker->thread.joinable())
+		{
+			worker->thread.join();
+		}
+	}
+
+	return;
+}
+
+
+Darknet::WorkerPool & Darknet::WorkerPool::get()
+{
+	TAT(TATPARMS);
+
+	std::scoped_lock lock(global_pool_mutex);
+
+	if (not global_pool)
+	{
+		global_pool = std::make_unique<WorkerPool>(default_number_of_workers());
+	}
+
+	return *global_pool;
+}
+
+
+void Darknet::WorkerPool::configure(size_t number_of_workers, const bool pin_to_cores)
+{
+	TAT(TATPARMS);
+
+	if (number_of_workers == 0)
+	{
+		number_of_workers = default_number_of_workers();
+	}
+
+	VInt cpus;
+	if (pin_to_cores)
+	{
+		const int cores = std::max(1u, std::thread::hardware_concurrency());
+		for (size_t idx = 0; idx < number_of_workers; idx ++)
+		{
+			cpus.push_back((idx + 1) % cores);
+		}
+	}
+
+	std::scoped_lock lock(global_pool_mutex);
+
+	// destroy the old pool first so we don't temporarily have twice as many threads
+	global_pool.reset();
+	global_pool = std::make_unique<WorkerPool>(number_of_workers, cpus);
+
+	if (cfg_and_state.is_verbose)
+	{
+		std::cout << "Worker pool has " << number_of_workers << " thread" << (number_of_workers == 1 ? "" : "s") << (pin_to_cores ? " pinned to cores" : "") << std::endl;
+	}
+
+	return;
+}
+
+
+Darknet::WorkerPool & Darknet::WorkerPool::current()
+{
+	TAT(TATPARMS);
+
+	if (current_pool)
+	{
+		return *current_pool;
+	}
+
+	return get();
+}
+
+
+void Darknet::WorkerPool::pin_current_thread(const VInt & cpus)
+{
+	TAT(TATPARMS);
+
+	if (cpus.empty())
+	{
+		return;
+	}
+
+	#ifdef WIN32
+	DWORD_PTR mask = 0;
+	for (const int cpu : cpus)
+	{
+		if (cpu >= 0 and cpu < static_cast<int>(8 * sizeof(DWORD_PTR)))
+		{
+			mask |= static_cast<DWORD_PTR>(1) << cpu;
+		}
+	}
+	if (mask)
+	{
+		SetThreadAffinityMask(GetCurrentThread(), mask);
+	}
+	#elif defined(__linux__)
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	for (const int cpu : cpus)
+	{
+		if (cpu >= 0 and cpu < CPU_SETSIZE)
+		{
+			CPU_SET(cpu, &cpu_set);
+		}
+	}
+	pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+	#endif
+
+	return;
+}
+
+
+size_t Darknet::WorkerPool::current_budget()
+{
+	TAT(TATPARMS);
+
+	return current_thread_budget;
+}
+
+
+size_t Darknet::WorkerPool::size() const
+{
+	TAT(TATPARMS);
+
+	return workers.size();
+}
+
+
+void Darknet::WorkerPool::submit(Task && task)
+{
+	TAT(TATPARMS);
+
+	if (workers.empty())
+	{
+		// nobody to give this to, so run it immediately
+		task();
+		return;
+	}
+
+	// increment the counter before the task is visible to the workers so it can never go negative
+	pending ++;
+
+	const size_t idx = next_worker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+	if (true)
+	{
+		std::scoped_lock lock(workers[idx]->mtx);
+		workers[idx]->tasks.push_back(std::move(task));
+	}
+
+	std::scoped_lock lock(sleep_mtx);
+	sleep_cv.notify_one();
+
+	return;
+}
+
+
+bool Darknet::WorkerPool::try_get_task(const size_t idx, Task & task)
+{
+	TAT(TATPARMS);
+
+	// first look at our own deque, taking the most recent task
+	if (true)
+	{
+		Worker & worker = *workers[idx];
+		std::scoped_lock lock(worker.mtx);
+		if (not worker.tasks.empty())
+		{
+			task = std::move(worker.tasks.back());
+			worker.tasks.pop_back();
+			return true;
+		}
+	}
+
+	// otherwise, attempt to steal the oldest task from one of the other workers
+	for (size_t offset = 1; offset < workers.size(); offset ++)
+	{
+		Worker & victim = *workers[(idx + offset) % workers.size()];
+		std::scoped_lock lock(victim.mtx);
+		if (not victim.tasks.empty())
+		{
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+void Darknet::WorkerPool::worker_loop(const size_t idx, const int cpu)
+{
+	TAT(TATPARMS);
+
+	cfg_and_state.set_thread_name(pool_name + " #" + std::to_string(idx));
+	if (cpu >= 0)
+	{
+		pin_current_thread({cpu});
+	}
+
+	// nested loops started from within this worker should run on the same pool
+	current_pool = this;
+
+	while (true)
+	{
+		Task task;
+		if (try_get_task(idx, task))
+		{
+			pending --;
+			try
+			{
+				task();
+			}
+			catch (const std::exception & e)
+			{
+				Darknet::display_warning_msg("exception caught in " + pool_name + " thread: " + e.what() + "\n");
+			}
+			continue;
+		}
+
+		// layers tend to call parallel_for() back-to-back, so spin briefly before going to sleep
+		bool work_is_available = false;
+		for (int spin = 0; spin < spin_count and not work_is_available; spin ++)
+		{
+			std::this_thread::yield();
+			work_is_available = pending.load(std::memory_order_acquire) > 0;
+		}
+		if (work_is_available)
+		{
+			continue;
+		}
+
+		std::unique_lock lock(sleep_mtx);
+		sleep_cv.wait(lock, [&]{ return pending > 0 or stop; });
+		if (stop and pending == 0)
+		{
+			break;
+		}
+	}
+
+	cfg_and_state.del_thread_name();
+
+	return;
+}
+
+
+void Darknet::WorkerPool::parallel_for(const int begin, const int end, const std::function<void(int, int)> & fn, const int grain, size_t max_threads)
+{
+	TAT(TATPARMS);
+
+	const int count = end - begin;
+	if (count <= 0)
+	{
+		return;
+	}
+
+	size_t threads = workers.size() + 1; // +1 for the calling thread
+	if (max_threads > 0)
+	{
+		threads = std::min(threads, max_threads);
+	}
+
+	// use several chunks per thread so a thread which finishes early can pick up more work
+	const int chunk_size = std::max(1, grain);
+	const int chunks = static_cast<int>(std::min(static_cast<size_t>((count + chunk_size - 1) / chunk_size), threads * 4));
+	if (threads <= 1 or chunks <= 1)
+	{
+		fn(begin, end);
+		return;
+	}
+	threads = std::min(threads, static_cast<size_t>(chunks));
+
+	/* Helper tasks may start after the loop has already completed (e.g., if the workers were busy), so everything
+	 * they reference must be kept alive by the shared pointer.  A late helper won't claim a chunk and therefore won't
+	 * touch the function, which is only guaranteed to exist until this call returns.
+	 */
+	struct Shared
+	{
+		std::atomic<int>						next_chunk		= 0;
+		std::atomic<int>						completed		= 0;
+		int										chunks			= 0;
+		int										begin			= 0;
+		int										count			= 0;
+		const std::function<void(int, int)> *	fn				= nullptr;
+		std::mutex								mtx;
+		std::condition_variable					cv;
+		std::exception_ptr						exception;
+	};
+	auto shared		= std::make_shared<Shared>();
+	shared->chunks	= chunks;
+	shared->begin	= begin;
+	shared->count	= count;
+	shared->fn		= &fn;
+
+	const auto work = [](Shared & s)
+	{
+		while (true)
+		{
+			const int chunk = s.next_chunk.fetch_add(1);
+			if (chunk >= s.chunks)
+			{
+				break;
+			}
+
+			const int chunk_begin	= s.begin + static_cast<int>(static_cast<int64_t>(s.count) * chunk / s.chunks);
+			const int chunk_end		= s.begin + static_cast<int>(static_cast<int64_t>(s.count) * (chunk + 1) / s.chunks);
+			try
+			{
+				(*s.fn)(chunk_begin, chunk_end);
+			}
+			catch (...)
+			{
+				std::scoped_lock lock(s.mtx);
+				if (not s.exception)
+				{
+					s.exception = std::current_exception();
+				}
+			}
+
+			if (s.completed.fetch_add(1) + 1 == s.chunks)
+			{
+				std::scoped_lock lock(s.mtx);
+				s.cv.notify_all();
+			}
+		}
+	};
+
+	WorkerPool * pool = this;
+	const size_t budget = current_thread_budget;
+	for (size_t idx = 1; idx < threads; idx ++)
+	{
+		submit([shared, work, pool, budget]()
+			{
+				Scope scope(pool, budget);
+				work(*shared);
+			});
+	}
+
+	// the calling thread does its share of the work
+	work(*shared);
+
+	// the remaining chunks are already running on other threads, and are typically about to finish
+	for (int spin = 0; spin < spin_count and shared->completed.load(std::memory_order_acquire) < chunks; spin ++)
+	{
+		std::this_thread::yield();
+	}
+	if (shared->completed.load(std::memory_order_acquire) < chunks)
+	{
+		std::unique_lock lock(shared->mtx);
+		shared->cv.wait(lock, [&]{ return shared->completed.load() >= chunks; });
+	}
+
+	if (shared->exception)
+	{
+		std::rethrow_exception(shared->exception);
+	}
+
+	return;
+}
+
+
+void Darknet::WorkerPool::run_concurrently(const std::vector<Task> & tasks, const size_t max_threads)
+{
+	TAT(TATPARMS);
+
+	// one chunk per task, so each task can be picked up by a different thread
+	parallel_for(0, static_cast<int>(tasks.size()),
+		[&tasks](const int chunk_begin, const int chunk_end)
+		{
+			for (int idx = chunk_begin; idx < chunk_end; idx ++)
+			{
+				tasks[idx]();
+			}
+		}, 1, max_threads);
+
+	return;
+}
@@ -0,0 +1,163 @@
+/* Darknet/YOLO:  https://github.com/hank-ai/darknet
+ * Copyright 2024 Stephane Charette
+ */
+
+#pragma once
+
+#include "darknet_internal.hpp"
+
+/** @file
+ * This file defines @ref Darknet::WorkerPool, the persistent set of threads used to parallelize CPU loops.
+ */
+
+
+namespace Darknet
+{
+	/** A persistent work-stealing thread pool.  This replaces the fork/join of @p "#pragma omp parallel for" regions in
+	 * the CPU layers.  Every worker has its own task deque.  Workers pop from the back of their own deque and steal from
+	 * the front of the other deques when they run out of work.
+	 *
+	 * There is one library-wide pool (see @ref get()), but additional pools can be created, for example to keep the
+	 * threads of one network on a specific set of cores.  Which pool a loop runs on, and how many threads it is allowed
+	 * to use, is decided by the current @ref Darknet::WorkerPool::Scope.
+	 *
+	 * @since 2026-10-18
+	 */
+	class WorkerPool final
+	{
+		public:
+
+			using Task = std::function<void()>;
+
+			/** RAII object which sets the pool and the thread budget used by @ref Darknet::parallel_for() on the current
+			 * thread.  The previous values are restored when the scope ends.  A @p budget of zero means "use all the
+			 * workers in the pool".  @see @ref Darknet::NetworkDetails::thread_budget
+			 *
+			 * @since 2026-10-18
+			 */
+			class Scope final
+			{
+				public:
+
+					Scope(WorkerPool * pool, const size_t budget);
+					~Scope();
+
+				private:
+
+					WorkerPool * previous_pool;
+					size_t previous_budget;
+			};
+
+			WorkerPool() = delete;
+			WorkerPool(const WorkerPool &) = delete;
+			WorkerPool & operator=(const WorkerPool &) = delete;
+
+			/** Create a pool with the given number of worker threads.  If @p cpus is not empty, then worker @p N is pinned
+			 * to core @p cpus[N % cpus.size()].
+			 *
+			 * @since 2026-10-18
+			 */
+			WorkerPool(const size_t number_of_workers, const VInt & cpus = VInt(), const std::string & name = "worker");
+
+			/// Destructor.  Pending tasks are completed before the workers exit.
+			~WorkerPool();
+
+			/** Get the library-wide pool.  Unless @ref configure() has been called, this has one worker per logical core
+			 * less one, since the thread calling @ref parallel_for() also does work.
+			 *
+			 * @since 2026-10-18
+			 */
+			static WorkerPool & get();
+
+			/** Re-create the library-wide pool.  This must not be called while a neural network is running.
+			 *
+			 * @param [in] number_of_workers Zero means one worker per logical core less one.
+			 * @param [in] pin_to_cores When @p true, worker @p N is pinned to core @p N+1, leaving core zero for the
+			 * calling thread.
+			 *
+			 * @since 2026-10-18
+			 */
+			static void configure(size_t number_of_workers, const bool pin_to_cores);
+
+			/// The pool to use on the current thread.  This is the library-wide pool unless a @ref Scope says otherwise.
+			static WorkerPool & current();
+
+			/// The thread budget on the current thread, or zero if there is no limit.  @see @ref Scope
+			static size_t current_budget();
+
+			/** Restrict the calling thread to the given set of cores.  Does nothing if @p cpus is empty.
+			 *
+			 * @since 2026-10-18
+			 */
+			static void pin_current_thread(const VInt & cpus);
+
+			/// The number of worker threads in this pool.
+			size_t size() const;
+
+			/// Queue a task which will be picked up by one of the workers.
+			void submit(Task && task);
+
+			/** Run the function @p fn over the range @p [begin, end) split into chunks of at least @p grain items.  The
+			 * calling thread also processes chunks, so this never deadlocks even when called from within a worker.  At
+			 * most @p max_threads threads (including the calling thread) will participate.  Zero means no limit.
+			 *
+			 * If @p fn throws, the first exception is re-thrown on the calling thread once all chunks have completed.
+			 */
+			void parallel_for(const int begin, const int end, const std::function<void(int, int)> & fn, const int grain = 1, size_t max_threads = 0);
+
+			/** Run several independent tasks concurrently, for example the branches of a neural network which do not
+			 * depend on each other.  Returns once all tasks have completed.
+			 */
+			void run_concurrently(const std::vector<Task> & tasks, const size_t max_threads = 0);
+
+		private:
+
+			struct Worker
+			{
+				std::mutex			mtx;
+				std::deque<Task>	tasks;
+				std::thread			thread;
+			};
+
+			void worker_loop(const size_t idx, const int cpu);
+			bool try_get_task(const size_t idx, Task & task);
+
+			std::vector<std::unique_ptr<Worker>> workers;
+			const std::string pool_name;
+
+			std::atomic<size_t>		next_worker;
+			std::atomic<size_t>		pending;
+			std::atomic<bool>		stop;
+			std::mutex				sleep_mtx;
+			std::condition_variable	sleep_cv;
+	};
+
+	/** Run @p fn(i) for every @p i in @p [begin, end) on the current @ref WorkerPool.  This is the replacement for
+	 * @p "#pragma omp parallel for".  The lambda is called directly inside each chunk so there is no per-item overhead.
+	 *
+	 * @since 2026-10-18
+	 */
+	template <typename F>
+	inline void parallel_for(const int begin, const int end, F && fn, const int grain = 1)
+	{
+		if (end - begin <= 1)
+		{
+			for (int i = begin; i < end; i ++)
+			{
+				fn(i);
+			}
+			return;
+		}
+
+		WorkerPool::current().parallel_for(begin, end,
+			[&fn](const int chunk_begin, const int chunk_end)
+			{
+				for (int i = chunk_begin; i < chunk_end; i ++)
+				{
+					fn(i);
+				}
+			}, grain, WorkerPool::current_budget());
+
+		return;
+	}
+}
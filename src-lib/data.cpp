@@ -8,7 +8,7 @@ namespace
 {
 	static auto & cfg_and_state = Darknet::CfgAndState::get();
 
-	/** The permanent data-loading (image, bboxes) threads started by @ref Darknet::run_image_loading_control_thread().
+	/** The permanent data-loading (image, bboxes) threads started by @ref Darknet::start_image_loading().
 	 *
 	 * @since 2024-04-03
 	 */
@@ -22,36 +22,194 @@ namespace
 	static std::atomic<bool> image_data_loading_threads_must_exit = false;
 
 
-	/** Flags to indicate to individual data loading threads what they should do.  @p 0 is stop, and @p 1 is go.
-	 * These flags are normally @p 0 and then are set to @p 1 by @ref run_image_loading_control_thread().
+	/** A batch of training images which is being loaded, or is ready to be used.  The row pointers are allocated when
+	 * the batch is created, and the loading threads store each image directly in its own row.
 	 *
-	 * (Was @p std::vector<bool> but that individual bit handling, and we only have a few threads.)
-	 *
-	 * @since 2024-04-10
+	 * @since 2026-10-18
 	 */
-	static std::vector<int> data_loading_per_thread_flag;
+	struct PendingBatch
+	{
+		data	d;				///< the images and bounding boxes
+		int		outstanding;	///< number of tasks which have not yet been loaded
+		size_t	generation;		///< the version of @ref loader_args used to create this batch
+		size_t	sequence;		///< the number of batches given to the training loop before this one
+	};
 
 
-	/// @{ @todo: delete these once the code is cleaned up
-	static const std::chrono::milliseconds thread_wait_ms(5); ///< @todo DELETE THIS! :(
-	static load_args * args_swap = NULL; ///< @todo I wish I better understood how/why this exists...
-	static std::mutex args_swap_mutex; // used to protect access to args_swap
+	/** Work given to the image loading threads.  This is typically a single image, but can be more than 1.
+	 *
+	 * @since 2026-10-18
+	 */
+	struct LoaderTask
+	{
+		load_args		args;
+		PendingBatch *	batch;
+		int				offset;	///< index of the first row in the batch where the images must be stored
+	};
+
+
+	/// @{ State shared by the prefetch thread, the image loading threads, and the training loop.  Protected by @ref loader_mutex.
+	static std::mutex loader_mutex;
+	static std::condition_variable loader_task_available;
+	static std::condition_variable loader_batch_finished;
+	static std::condition_variable loader_space_available;
+	static std::deque<LoaderTask> loader_tasks;
+	static std::deque<std::unique_ptr<PendingBatch>> loader_batches; ///< oldest batch is at the front
+	static load_args loader_args;
+	static size_t loader_generation = 0;
+	static size_t loader_depth = 1;
+	static uint64_t loader_seed = 0;
+	static size_t loader_sequence = 0;			///< sequence number of the next batch to be queued
+	static size_t loader_batches_returned = 0;	///< number of batches given to the training loop
+	static Darknet::BatchSchedule loader_schedule;
 	/// @}
 
 
-	static inline data concat_datas(data *d, int n)
+	/// The thread started by @ref Darknet::start_image_loading() which keeps the prefetch queue full.
+	static std::thread loader_prefetch_thread;
+
+
+	/// Total time spent by the image loading threads loading images, used to calculate the utilisation.
+	static std::atomic<uint64_t> loader_busy_nanoseconds = 0;
+
+
+	/// Fraction of time the image loading threads spent loading images since the previous batch was returned.
+	static std::atomic<float> loader_utilisation = 0.0f;
+
+
+	/// Time spent by the image loading threads in each stage, used by "darknet detector loadbench".
+	static std::array<std::atomic<uint64_t>, static_cast<size_t>(Darknet::ELoaderStage::kMax)> loader_stage_totals = {};
+
+
+	/// When the previous batch was returned by @ref Darknet::get_next_training_batch().
+	static std::chrono::high_resolution_clock::time_point loader_utilisation_timestamp;
+
+
+	/** How long an idle thread waits before checking @ref Darknet::CfgAndState::must_immediately_exit again, which can
+	 * be set from a signal handler where the condition variables cannot be used.
+	 */
+	static const std::chrono::milliseconds exit_check_interval(100);
+
+
+	/** Allocate a new batch and queue the tasks needed to load all of the images.  The lock on @ref loader_mutex must be
+	 * held by the caller.
+	 */
+	static inline void queue_new_batch(load_args args)
 	{
 		TAT(TATPARMS);
 
-		data out = {0};
-		for (int i = 0; i < n; ++i)
+		if (loader_schedule)
+		{
+			// settings such as the network dimensions may be different for each batch
+			loader_schedule(loader_sequence, args);
+		}
+
+		const int number_of_images = std::max(1, args.n); // typically will be 64 (batch size)
+
+		/* Images are queued individually so a few slow images cannot hold up an entire slice of the batch.  There are 2
+		 * exceptions:  contrastive learning needs both images of a pair to be loaded together, and tracking needs each
+		 * sequence of frames to be loaded by a single call.  In tracking mode the batch is still split into one slice
+		 * per "thread" as was done in the past.
+		 */
+		int number_of_tasks = number_of_images;
+		if (args.track)
+		{
+			number_of_tasks = std::max(1, args.threads);
+		}
+		else if (args.contrastive)
+		{
+			number_of_tasks = (number_of_images + 1) / 2;
+		}
+
+		auto batch = std::make_unique<PendingBatch>();
+		batch->d = {};
+		batch->d.shallow	= 0;
+		batch->d.w			= args.w;
+		batch->d.h			= args.h;
+		batch->d.X.rows		= number_of_images;
+		batch->d.X.vals		= (float**)xcalloc(number_of_images, sizeof(float*));
+		batch->d.y.rows		= number_of_images;
+		batch->d.y.vals		= (float**)xcalloc(number_of_images, sizeof(float*));
+		batch->outstanding	= 0;
+		batch->generation	= loader_generation;
+		batch->sequence		= loader_sequence ++;
+
+		for (int idx = 0; idx < number_of_tasks; ++idx)
+		{
+			LoaderTask task;
+			task.args	= args;
+			task.batch	= batch.get();
+			task.offset	= idx * number_of_images / number_of_tasks;
+			task.args.n	= (idx + 1) * number_of_images / number_of_tasks - task.offset;
+			if (task.args.n > 0)
+			{
+				loader_tasks.push_back(task);
+				batch->outstanding ++;
+			}
+		}
+
+		loader_batches.push_back(std::move(batch));
+
+		return;
+	}
+
+
+	/// The hash used to create unique track IDs for the objects in each annotation file.
+	static inline int label_hash(const char * labelpath)
+	{
+		TAT(TATPARMS);
+
+		const int max_obj_img = 4000;// 30000;
+
+		return (custom_hash(const_cast<char *>(labelpath)) % max_obj_img) * max_obj_img;
+	}
+
+
+	static inline void set_box_label(box_label & box, const int track_id, const int id, const float x, const float y, const float w, const float h)
+	{
+		TAT(TATPARMS);
+
+		box.track_id = track_id;
+		box.id = id;
+		box.x = x;
+		box.y = y;
+		box.h = h;
+		box.w = w;
+		box.left   = x - w / 2.0f;
+		box.right  = x + w / 2.0f;
+		box.top    = y - h / 2.0f;
+		box.bottom = y + h / 2.0f;
+
+		return;
+	}
+
+
+	/// Get the name of the annotation file for this image.  This is only needed for error messages.
+	static inline std::string label_filename(const char * image_path)
+	{
+		TAT(TATPARMS);
+
+		char labelpath[4096];
+		replace_image_to_label(image_path, labelpath);
+
+		return labelpath;
+	}
+
+
+	/// Same as @p read_boxes() but the boxes come from a packed dataset instead of the annotation file.
+	static inline box_label * packed_boxes_to_labels(const char * labelpath, const Darknet::PackedBox * packed_boxes, const int count)
+	{
+		TAT(TATPARMS);
+
+		box_label * boxes = (box_label*)xcalloc(std::max(1, count), sizeof(box_label));
+		const int img_hash = label_hash(labelpath);
+		for (int i = 0; i < count; ++i)
 		{
-			data newdata = concat_data(d[i], out);
-			Darknet::free_data(out);
-			out = newdata;
+			const auto & pb = packed_boxes[i];
+			set_box_label(boxes[i], i + img_hash, pb.id, pb.x, pb.y, pb.w, pb.h);
 		}
 
-		return out;
+		return boxes;
 	}
 }
 
@@ -165,8 +323,7 @@ box_label *read_boxes(char *filename, int *n)
 		darknet_fatal_error(DARKNET_LOC, "failed to open annotation file \"%s\"", filename);
 	}
 
-	const int max_obj_img = 4000;// 30000;
-	const int img_hash = (custom_hash(filename) % max_obj_img)*max_obj_img;
+	const int img_hash = label_hash(filename);
 	float x, y, h, w;
 	int id;
 	int count = 0;
@@ -175,16 +332,7 @@ box_label *read_boxes(char *filename, int *n)
 //		std::cout << "x=" << x << " y=" << y << " w=" << w << " h=" << h << std::endl;
 
 		boxes = (box_label*)xrealloc(boxes, (count + 1) * sizeof(box_label));
-		boxes[count].track_id = count + img_hash;
-		boxes[count].id = id;
-		boxes[count].x = x;
-		boxes[count].y = y;
-		boxes[count].h = h;
-		boxes[count].w = w;
-		boxes[count].left   = x - w / 2.0f;
-		boxes[count].right  = x + w / 2.0f;
-		boxes[count].top    = y - h / 2.0f;
-		boxes[count].bottom = y + h / 2.0f;
+		set_box_label(boxes[count], count + img_hash, id, x, y, w, h);
 		++count;
 	}
 
@@ -195,6 +343,34 @@ box_label *read_boxes(char *filename, int *n)
 }
 
 
+box_label *read_boxes_for_image(const char *image_path, int *n)
+{
+	TAT(TATPARMS);
+
+	// the label cache already has the final box_label structures, so this is the fastest way to get the boxes
+	box_label *boxes = Darknet::get_cached_boxes(image_path, *n);
+	if (boxes)
+	{
+		return boxes;
+	}
+
+	char labelpath[4096];
+	replace_image_to_label(image_path, labelpath);
+
+	const Darknet::PackedBox * packed_boxes = Darknet::get_packed_boxes(image_path, *n);
+	if (packed_boxes == nullptr)
+	{
+		packed_boxes = Darknet::get_streamed_boxes(image_path, *n);
+	}
+	if (packed_boxes)
+	{
+		return packed_boxes_to_labels(labelpath, packed_boxes, *n);
+	}
+
+	return read_boxes(labelpath, n);
+}
+
+
 void randomize_boxes(box_label *b, int n)
 {
 	TAT(TATPARMS);
@@ -266,12 +442,9 @@ int fill_truth_detection(const char *path, int num_boxes, int truth_size, float
 
 	TAT(TATPARMS);
 
-	char labelpath[4096];
-	replace_image_to_label(path, labelpath);
-
 	int count = 0;
 	int i;
-	box_label *boxes = read_boxes(labelpath, &count);
+	box_label *boxes = read_boxes_for_image(path, &count);
 	int min_w_h = 0;
 	float lowest_w = 1.F / net_w;
 	float lowest_h = 1.F / net_h;
@@ -300,11 +473,11 @@ int fill_truth_detection(const char *path, int num_boxes, int truth_size, float
 		//char buff[256];
 		if (id >= classes)
 		{
-			darknet_fatal_error(DARKNET_LOC, "invalid class ID #%d in %s", id, labelpath);
+			darknet_fatal_error(DARKNET_LOC, "invalid class ID #%d in %s", id, label_filename(path).c_str());
 		}
 		if ((w < lowest_w || h < lowest_h))
 		{
-			//sprintf(buff, "echo %s \"Very small object: w < lowest_w OR h < lowest_h\" >> bad_label.list", labelpath);
+			//sprintf(buff, "echo %s \"Very small object: w < lowest_w OR h < lowest_h\" >> bad_label.list", label_filename(path).c_str());
 			//system(buff);
 			++sub;
 			continue;
@@ -312,22 +485,22 @@ int fill_truth_detection(const char *path, int num_boxes, int truth_size, float
 
 		if (x == 999999 || y == 999999)
 		{
-			darknet_fatal_error(DARKNET_LOC, "invalid annotation for class ID #%d in %s", id, labelpath);
+			darknet_fatal_error(DARKNET_LOC, "invalid annotation for class ID #%d in %s", id, label_filename(path).c_str());
 		}
 		/// @todo shouldn't this be x - w/2 < 0.0f?  And same for other variables?
 		if (x <= 0.0f || x > 1.0f || y <= 0.0f || y > 1.0f)
 		{
-			darknet_fatal_error(DARKNET_LOC, "invalid coordinates for class ID #%d in %s", id, labelpath);
+			darknet_fatal_error(DARKNET_LOC, "invalid coordinates for class ID #%d in %s", id, label_filename(path).c_str());
 		}
 		/// @todo again, instead of checking for > 1, shouldn't we check x + w / 2 ?
 		if (w > 1.0f)
 		{
-			darknet_fatal_error(DARKNET_LOC, "invalid width for class ID #%d in %s", id, labelpath);
+			darknet_fatal_error(DARKNET_LOC, "invalid width for class ID #%d in %s", id, label_filename(path).c_str());
 		}
 		/// @todo check for y - h/2 and y + h/2?
 		if (h > 1.0f)
 		{
-			darknet_fatal_error(DARKNET_LOC, "invalid height for class ID #%d in %s", id, labelpath);
+			darknet_fatal_error(DARKNET_LOC, "invalid height for class ID #%d in %s", id, label_filename(path).c_str());
 		}
 
 		if (x == 0) x += lowest_w;
@@ -690,6 +863,9 @@ data load_data_detection(int n, char **paths, int m, int w, int h, int c, int bo
 
 	d.y = make_matrix(n, truth_size * boxes);
 
+	// mosaic images are assembled in 8-bit, and only converted to float once all 4 quadrants have been written
+	std::vector<cv::Mat> mosaic(use_mixup == 3 ? n : 0);
+
 	for (int i_mixup = 0; i_mixup <= use_mixup; i_mixup++)
 	{
 		if (i_mixup)
@@ -698,7 +874,12 @@ data load_data_detection(int n, char **paths, int m, int w, int h, int c, int bo
 		}
 
 		char **random_paths;
-		if (track)
+		if (Darknet::is_streaming_dataset_open())
+		{
+			// the images come from the shuffle buffer of the .tar shards
+			random_paths = Darknet::get_streamed_paths(n, contrastive);
+		}
+		else if (track)
 		{
 			random_paths = get_sequential_paths(paths, n, m, mini_batch, augment_speed, contrastive);
 		}
@@ -707,13 +888,38 @@ data load_data_detection(int n, char **paths, int m, int w, int h, int c, int bo
 			random_paths = get_random_paths_custom(paths, n, m, contrastive);
 		}
 
+		/* Large JPEG images can be decoded at a reduced size.  The random crop below can keep as little as
+		 * (1/resize - 2*jitter) of the image, so make sure that even the smallest crop is not smaller than the network.
+		 */
+		cv::Size minimum_image_size;
+		const float smallest_crop = (resize > 1.0f ? 1.0f / resize : 1.0f) - 2.0f * jitter;
+		if (smallest_crop > 0.0f)
+		{
+			minimum_image_size = cv::Size(static_cast<int>(std::ceil(w / smallest_crop)), static_cast<int>(std::ceil(h / smallest_crop)));
+		}
+
 		// about to load multiple images ("n"), usually batch size divided by the number of loading threads
 		for (int i = 0; i < n; ++i)
 		{
 			float *truth = (float*)xcalloc(truth_size * boxes, sizeof(float));
 			const char *filename = random_paths[i];
 
-			cv::Mat src = load_rgb_mat_image(filename, c);
+			// use the image from the .tar shard when streaming, or the pre-decoded image when the dataset has been packed,
+			// otherwise decode the image file
+			cv::Mat src;
+			if (true)
+			{
+				Darknet::LoaderStageTimer timer(Darknet::ELoaderStage::kDecode);
+				src = Darknet::get_streamed_image(filename, c);
+				if (src.empty())
+				{
+					src = Darknet::get_packed_image(filename, c);
+				}
+				if (src.empty())
+				{
+					src = load_rgb_mat_image(filename, c, minimum_image_size);
+				}
+			}
 
 			const int oh = src.rows;	// original height
 			const int ow = src.cols;	// original width
@@ -869,7 +1075,12 @@ data load_data_detection(int n, char **paths, int m, int w, int h, int c, int bo
 			const float dy = ((float)ptop / oh) / sy;
 
 			// This is where we get the annotations for this image.
-			const int min_w_h = fill_truth_detection(filename, boxes, truth_size, truth, classes, flip, dx, dy, 1. / sx, 1. / sy, w, h);
+			int min_w_h = 0;
+			if (true)
+			{
+				Darknet::LoaderStageTimer timer(Darknet::ELoaderStage::kLabels);
+				min_w_h = fill_truth_detection(filename, boxes, truth_size, truth, classes, flip, dx, dy, 1. / sx, 1. / sy, w, h);
+			}
 			//for (int z = 0; z < boxes; ++z) if(truth[z*truth_size] > 0) printf(" track_id = %f \n", truth[z*truth_size + 5]);
 			//printf(" truth_size = %d \n", truth_size);
 
@@ -878,7 +1089,12 @@ data load_data_detection(int n, char **paths, int m, int w, int h, int c, int bo
 				blur = min_w_h / 8;   // disable blur if one of the objects is too small
 			}
 
-			Darknet::Image ai = image_data_augmentation(src, w, h, pleft, ptop, swidth, sheight, flip, dhue, dsat, dexp, gaussian_noise, blur, boxes, truth_size, truth);
+			Darknet::Image ai = {};
+			if (use_mixup != 3)
+			{
+				Darknet::LoaderStageTimer timer(Darknet::ELoaderStage::kAugment);
+				ai = image_data_augmentation(src, w, h, pleft, ptop, swidth, sheight, flip, dhue, dsat, dexp, gaussian_noise, blur, boxes, truth_size, truth);
+			}
 
 			if (use_mixup == 0)
 			{
@@ -899,6 +1115,7 @@ data load_data_detection(int n, char **paths, int m, int w, int h, int c, int bo
 					//show_image(ai, "new");
 					//show_image(old_img, "old");
 					//cv::waitKey(0);
+					Darknet::LoaderStageTimer timer(Darknet::ELoaderStage::kBlend);
 					blend_images_cv(ai, 0.5, old_img, 0.5);
 					blend_truth(d.y.vals[i], boxes, truth_size, truth);
 					Darknet::free_image(old_img);
@@ -909,10 +1126,10 @@ data load_data_detection(int n, char **paths, int m, int w, int h, int c, int bo
 			{
 				if (i_mixup == 0)
 				{
-					Darknet::Image tmp_img = make_image(w, h, c);
-					d.X.vals[i] = tmp_img.data;
+					mosaic[i] = cv::Mat(h, w, src.type());
 				}
 
+				const int crop_left = pleft;
 				if (flip)
 				{
 					int tmp = pleft;
@@ -927,39 +1144,46 @@ data load_data_detection(int n, char **paths, int m, int w, int h, int c, int bo
 				const int bot_shift = min_val_cmp(h - cut_y[i], max_val_cmp(0, (-pbot*h / oh)));
 
 
-				//int k, x, y;
-				for (int k = 0; k < c; ++k)
+				// work out which part of the augmented image is visible in this quadrant of the mosaic
+				cv::Rect quadrant;
+				cv::Point offset;
+				if (i_mixup == 0)
 				{
-					for (int y = 0; y < h; ++y)
-					{
-						int j = y*w + k*w*h;
-						if (i_mixup == 0 && y < cut_y[i])
-						{
-							int j_src = (w - cut_x[i] - right_shift) + (y + h - cut_y[i] - bot_shift)*w + k*w*h;
-							memcpy(&d.X.vals[i][j + 0], &ai.data[j_src], cut_x[i] * sizeof(float));
-						}
-						if (i_mixup == 1 && y < cut_y[i])
-						{
-							int j_src = left_shift + (y + h - cut_y[i] - bot_shift)*w + k*w*h;
-							memcpy(&d.X.vals[i][j + cut_x[i]], &ai.data[j_src], (w-cut_x[i]) * sizeof(float));
-						}
-						if (i_mixup == 2 && y >= cut_y[i])
-						{
-							int j_src = (w - cut_x[i] - right_shift) + (top_shift + y - cut_y[i])*w + k*w*h;
-							memcpy(&d.X.vals[i][j + 0], &ai.data[j_src], cut_x[i] * sizeof(float));
-						}
-						if (i_mixup == 3 && y >= cut_y[i])
-						{
-							int j_src = left_shift + (top_shift + y - cut_y[i])*w + k*w*h;
-							memcpy(&d.X.vals[i][j + cut_x[i]], &ai.data[j_src], (w - cut_x[i]) * sizeof(float));
-						}
-					}
+					quadrant = cv::Rect(0, 0, cut_x[i], cut_y[i]);
+					offset = cv::Point(w - cut_x[i] - right_shift, h - cut_y[i] - bot_shift);
+				}
+				else if (i_mixup == 1)
+				{
+					quadrant = cv::Rect(cut_x[i], 0, w - cut_x[i], cut_y[i]);
+					offset = cv::Point(left_shift, h - cut_y[i] - bot_shift);
+				}
+				else if (i_mixup == 2)
+				{
+					quadrant = cv::Rect(0, cut_y[i], cut_x[i], h - cut_y[i]);
+					offset = cv::Point(w - cut_x[i] - right_shift, top_shift);
+				}
+				else
+				{
+					quadrant = cv::Rect(cut_x[i], cut_y[i], w - cut_x[i], h - cut_y[i]);
+					offset = cv::Point(left_shift, top_shift);
+				}
+
+				if (true)
+				{
+					Darknet::LoaderStageTimer timer(Darknet::ELoaderStage::kAugment);
+					mosaic_data_augmentation(src, mosaic[i], quadrant, offset, w, h, crop_left, ptop, swidth, sheight, flip, dhue, dsat, dexp, gaussian_noise, blur, boxes, truth_size, truth);
 				}
 
+				Darknet::LoaderStageTimer timer(Darknet::ELoaderStage::kBlend);
 				blend_truth_mosaic(d.y.vals[i], boxes, truth_size, truth, w, h, cut_x[i], cut_y[i], i_mixup, left_shift, right_shift, top_shift, bot_shift, w, h, mosaic_bound);
 
-				Darknet::free_image(ai);
-				ai.data = d.X.vals[i];
+				if (i_mixup == 3)
+				{
+					// this is the only time the mosaic is converted to float
+					ai = Darknet::mat_to_image(mosaic[i]);
+					d.X.vals[i] = ai.data;
+					mosaic[i].release();
+				}
 			}
 
 			if (show_imgs && i_mixup == use_mixup)   // delete i_mixup
@@ -1047,7 +1271,7 @@ void Darknet::load_single_image_data(load_args args)
 }
 
 
-void Darknet::image_loading_loop(const int idx, load_args args)
+void Darknet::image_loading_loop(const int idx)
 {
 	// This loop runs on a secondary thread.
 
@@ -1055,34 +1279,64 @@ void Darknet::image_loading_loop(const int idx, load_args args)
 
 	cfg_and_state.set_thread_name("image loading loop #" + std::to_string(idx));
 
-	const int number_of_threads	= args.threads;	// typically will be 6
-	const int number_of_images	= args.n;		// typically will be 64 (batch size)
-
-	// calculate the number of images this thread needs to load at once
-	// e.g., 64 batch size / 6 threads = 10 or 11 images per thread
-	args.n = (idx + 1) * number_of_images / number_of_threads - idx * number_of_images / number_of_threads;
-
-	while (image_data_loading_threads_must_exit == false and
-			cfg_and_state.must_immediately_exit == false)
+	while (true)
 	{
-		/// @todo get rid of this busy-loop
+		LoaderTask task;
 
-		// wait until the control thread tells us we can load the next set of images
-		if (data_loading_per_thread_flag[idx] == 0)
+		if (true)
 		{
-			std::this_thread::sleep_for(thread_wait_ms);
-			continue;
+			std::unique_lock lock(loader_mutex);
+			while (loader_tasks.empty() and image_data_loading_threads_must_exit == false and cfg_and_state.must_immediately_exit == false)
+			{
+				loader_task_available.wait_for(lock, exit_check_interval);
+			}
+
+			if (loader_tasks.empty())
+			{
+				// we were told to exit
+				break;
+			}
+
+			task = loader_tasks.front();
+			loader_tasks.pop_front();
 		}
 
-		// if we get here, then the control thread has told us to load the next image
+		data piece = {};
+		task.args.d = &piece;
+
+		/* Every image gets its own random numbers based on the seed and the position of the image within the
+		 * training, so a batch can be recreated exactly no matter which thread loads which image.
+		 */
+		set_rng_stream(loader_seed, task.batch->sequence * task.batch->d.X.rows + task.offset);
 
-		args_swap_mutex.lock();
-		load_args args_local = args_swap[idx];
-		args_swap_mutex.unlock();
+		const auto timestamp_start = std::chrono::high_resolution_clock::now();
+		Darknet::load_single_image_data(task.args);
+		const auto timestamp_end = std::chrono::high_resolution_clock::now();
+		clear_rng_stream();
 
-		Darknet::load_single_image_data(args_local);
+		loader_busy_nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp_end - timestamp_start).count();
 
-		data_loading_per_thread_flag[idx] = 0;
+		if (true)
+		{
+			std::scoped_lock lock(loader_mutex);
+			Darknet::LoaderStageTimer timer(Darknet::ELoaderStage::kBatch);
+
+			// move the rows into the batch -- this is only pointers, the images themselves are not copied
+			auto & d = task.batch->d;
+			d.X.cols = piece.X.cols;
+			d.y.cols = piece.y.cols;
+			for (int row = 0; row < piece.X.rows and task.offset + row < d.X.rows; ++row)
+			{
+				d.X.vals[task.offset + row] = piece.X.vals[row];
+				d.y.vals[task.offset + row] = piece.y.vals[row];
+			}
+
+			task.batch->outstanding --;
+		}
+		piece.shallow = 1;
+		Darknet::free_data(piece);
+
+		loader_batch_finished.notify_all();
 	}
 
 	cfg_and_state.del_thread_name();
@@ -1091,106 +1345,277 @@ void Darknet::image_loading_loop(const int idx, load_args args)
 }
 
 
-void Darknet::run_image_loading_control_thread(load_args args)
+void Darknet::run_image_loading_control_thread()
 {
-	/* NOTE:  This is normally started on a new thread!  For example, you might see this:
-	 *
-	 *		std::thread t(Darknet::run_image_loading_control_thread, args);
-	 */
-
 	TAT(TATPARMS);
 
 	cfg_and_state.set_thread_name("image loading control thread");
 
-	if (args.threads == 0)
+	while (true)
+	{
+		std::unique_lock lock(loader_mutex);
+
+		// batches created with old settings are still in the queue until they are discarded, so they are not counted
+		const auto current_batches = [&]()
+		{
+			return std::count_if(loader_batches.begin(), loader_batches.end(),
+				[](const auto & batch)
+				{
+					return batch->generation == loader_generation;
+				});
+		};
+
+		while (static_cast<size_t>(current_batches()) >= loader_depth and image_data_loading_threads_must_exit == false and cfg_and_state.must_immediately_exit == false)
+		{
+			loader_space_available.wait_for(lock, exit_check_interval);
+		}
+
+		if (image_data_loading_threads_must_exit or cfg_and_state.must_immediately_exit)
+		{
+			break;
+		}
+
+		queue_new_batch(loader_args);
+		loader_task_available.notify_all();
+	}
+
+	cfg_and_state.del_thread_name();
+
+	return;
+}
+
+
+void Darknet::start_image_loading(load_args args, const int prefetch_depth, uint64_t seed)
+{
+	TAT(TATPARMS);
+
+	if (loader_prefetch_thread.joinable())
+	{
+		throw std::logic_error("the image loading threads have already been started");
+	}
+
+	if (args.threads < 1)
 	{
 		args.threads = 1;
 	}
-	const int number_of_threads	= args.threads;	// typically will be 6
-	const int number_of_images	= args.n;		// typically will be 64 (batch size)
 
-	data * out = args.d;
-	data * buffers = (data*)xcalloc(number_of_threads, sizeof(data));
+	if (true)
+	{
+		std::scoped_lock lock(loader_mutex);
+		loader_args		= args;
+		loader_depth	= std::max(1, prefetch_depth);
+		loader_seed		= seed;
+		loader_sequence	= 0;
+		loader_batches_returned = 0;
+		loader_generation ++;
+	}
 
 	// create the secondary threads
 	if (data_loading_threads.empty())
 	{
+		const int number_of_threads = args.threads; // typically will be 6
 		std::cout << "Creating " << number_of_threads << " permanent CPU threads to load images and bounding boxes." << std::endl;
 
-		data_loading_threads			.reserve(number_of_threads);
-		data_loading_per_thread_flag	.reserve(number_of_threads);
-
-		args_swap = (load_args *)xcalloc(number_of_threads, sizeof(load_args));
-
+		data_loading_threads.reserve(number_of_threads);
 		for (int idx = 0; idx < number_of_threads; ++idx)
 		{
-			data_loading_per_thread_flag.push_back(0);
-			data_loading_threads.emplace_back(image_loading_loop, idx, args);
+			data_loading_threads.emplace_back(image_loading_loop, idx);
 		}
 	}
 
-	// tell each thread that we want more images, and where they can be stored
-	for (int idx = 0; idx < number_of_threads; ++idx)
-	{
-		args.d = buffers + idx;
-		args.n = (idx + 1) * number_of_images / number_of_threads - idx * number_of_images / number_of_threads;
+	std::cout
+		<< "Up to " << std::max(1, prefetch_depth) << " batches of images will be loaded ahead of time." << std::endl
+		<< "The random seed used to load images is " << seed << "." << std::endl;
+
+	loader_busy_nanoseconds = 0;
+	loader_utilisation_timestamp = std::chrono::high_resolution_clock::now();
+	loader_prefetch_thread = std::thread(run_image_loading_control_thread);
+
+	return;
+}
+
 
-		args_swap_mutex.lock();
-		args_swap[idx] = args;
-		args_swap_mutex.unlock();
+void Darknet::set_training_batch_schedule(Darknet::BatchSchedule schedule)
+{
+	TAT(TATPARMS);
 
-		data_loading_per_thread_flag[idx] = 1;
+	std::scoped_lock lock(loader_mutex);
+	loader_schedule = schedule;
+
+	return;
+}
+
+
+void Darknet::update_image_loading(load_args args)
+{
+	TAT(TATPARMS);
+
+	if (args.threads < 1)
+	{
+		args.threads = 1;
 	}
 
-	// wait for the loading threads to be done
-	for (int idx = 0; idx < number_of_threads; ++idx)
+	if (true)
 	{
-		while (image_data_loading_threads_must_exit == false and
-				cfg_and_state.must_immediately_exit == false and
-				data_loading_per_thread_flag[idx] != 0) // the loading thread will reset this flag to zero once it is ready
+		std::scoped_lock lock(loader_mutex);
+
+		loader_args = args;
+		loader_generation ++;
+
+		// batches already queued will be discarded, so the new batches are numbered from the next one to be used
+		loader_sequence = loader_batches_returned;
+
+		// forget the images from the old batches which nobody has started to load
+		for (auto iter = loader_tasks.begin(); iter != loader_tasks.end(); )
 		{
-			std::this_thread::sleep_for(thread_wait_ms);
+			if (iter->batch->generation != loader_generation)
+			{
+				iter->batch->outstanding --;
+				iter = loader_tasks.erase(iter);
+			}
+			else
+			{
+				++ iter;
+			}
 		}
 	}
 
-	// process the results
-	*out = concat_datas(buffers, number_of_threads);
-	out->shallow = 0;
+	loader_space_available.notify_all();
+	loader_batch_finished.notify_all();
+
+	return;
+}
+
+
+data Darknet::get_next_training_batch()
+{
+	TAT(TATPARMS);
 
-	for (int idx = 0; idx < number_of_threads; ++idx)
+	std::unique_lock lock(loader_mutex);
+
+	while (true)
 	{
-		buffers[idx].shallow = 1;
-		Darknet::free_data(buffers[idx]);
+		// an exit request does not stop the images which have already been queued, so the batch will be complete
+		while (loader_batches.empty() or loader_batches.front()->outstanding > 0)
+		{
+			if (image_data_loading_threads_must_exit or
+				not loader_prefetch_thread.joinable() or
+				(cfg_and_state.must_immediately_exit and loader_batches.empty()))
+			{
+				// there is nothing left to give the caller
+				return data{};
+			}
+			loader_batch_finished.wait_for(lock, exit_check_interval);
+		}
+
+		std::unique_ptr<PendingBatch> batch = std::move(loader_batches.front());
+		loader_batches.pop_front();
+		loader_space_available.notify_all();
+
+		if (batch->generation != loader_generation)
+		{
+			// this batch was loaded with old settings (such as the previous network dimensions)
+			Darknet::free_data(batch->d);
+			continue;
+		}
+
+		const auto now = std::chrono::high_resolution_clock::now();
+		const double available_nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(now - loader_utilisation_timestamp).count() * data_loading_threads.size();
+		if (available_nanoseconds > 0.0)
+		{
+			loader_utilisation = std::min(1.0, loader_busy_nanoseconds.exchange(0) / available_nanoseconds);
+		}
+		loader_utilisation_timestamp = now;
+		loader_batches_returned ++;
+
+		return batch->d;
 	}
-	free(buffers);
+}
 
-	cfg_and_state.del_thread_name();
+
+float Darknet::image_loading_utilisation()
+{
+	TAT(TATPARMS);
+
+	return loader_utilisation;
+}
+
+
+Darknet::LoaderStageTimer::LoaderStageTimer(const ELoaderStage s) :
+	stage(s),
+	timestamp(std::chrono::high_resolution_clock::now())
+{
+	return;
+}
+
+
+Darknet::LoaderStageTimer::~LoaderStageTimer()
+{
+	const auto duration = std::chrono::high_resolution_clock::now() - timestamp;
+	loader_stage_totals[static_cast<size_t>(stage)] += std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
 
 	return;
 }
 
 
+std::vector<uint64_t> Darknet::loader_stage_nanoseconds(const bool reset)
+{
+	TAT(TATPARMS);
+
+	std::vector<uint64_t> v;
+	for (auto & total : loader_stage_totals)
+	{
+		v.push_back(reset ? total.exchange(0) : total.load());
+	}
+
+	return v;
+}
+
+
 void Darknet::stop_image_loading_threads()
 {
 	TAT(TATPARMS);
 
-	if (not data_loading_threads.empty())
+	if (true)
 	{
+		std::scoped_lock lock(loader_mutex);
 		image_data_loading_threads_must_exit = true;
 
-		for (auto & t : data_loading_threads)
+		// forget the images nobody has started to load
+		for (auto & task : loader_tasks)
 		{
-			if (t.joinable())
-			{
-				t.join();
-			}
+			task.batch->outstanding --;
 		}
-		free(args_swap);
-		data_loading_threads.clear();
+		loader_tasks.clear();
+	}
+	loader_task_available.notify_all();
+	loader_space_available.notify_all();
+	loader_batch_finished.notify_all();
 
-		image_data_loading_threads_must_exit = false;
+	if (loader_prefetch_thread.joinable())
+	{
+		loader_prefetch_thread.join();
 	}
 
+	for (auto & t : data_loading_threads)
+	{
+		if (t.joinable())
+		{
+			t.join();
+		}
+	}
+	data_loading_threads.clear();
+
+	// the loading threads are gone so nothing else can be writing to the batches
+	for (auto & batch : loader_batches)
+	{
+		Darknet::free_data(batch->d);
+	}
+	loader_batches.clear();
+	loader_schedule = nullptr;
+
+	image_data_loading_threads_must_exit = false;
+
 	return;
 }
 
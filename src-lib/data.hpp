@@ -9,6 +9,15 @@
 
 data load_data_detection(int n, char **paths, int m, int w, int h, int c, int boxes, int truth_size, int classes, int use_flip, int gaussian_noise, int use_blur, int use_mixup, float jitter, float resize, float hue, float saturation, float exposure, int mini_batch, int track, int augment_speed, int letter_box, int mosaic_bound, int contrastive, int contrastive_jit_flip, int contrastive_color, int show_imgs);
 box_label *read_boxes(char *filename, int *n);
+
+/** Get the bounding boxes for the given image (not the annotation file).  This uses the label cache or the packed
+ * dataset when possible, and otherwise reads the annotation file.  The caller must @p free() the boxes.
+ *
+ * @see @ref Darknet::load_label_cache()
+ *
+ * @since 2026-10-18
+ */
+box_label *read_boxes_for_image(const char *image_path, int *n);
 list *get_paths(const char *filename);
 
 data get_data_part(data d, int part, int total);
@@ -18,8 +27,58 @@ data concat_data(data d1, data d2);
 
 namespace Darknet
 {
-	/** This runs as a @p std::thread.  It is started by the main thread during training and ensures the data-loading
-	 * threads are running.  This starts the thread that controls all of the permanent image loading threads.
+	/** Start loading training images.  This creates the permanent image loading threads, and the thread which keeps
+	 * up to @p prefetch_depth batches queued ahead of the training loop.  Each batch is then obtained by calling
+	 * @ref get_next_training_batch().
+	 *
+	 * The augmentation of each image only depends on @p seed and where the image appears in the training, so using the
+	 * same seed again reproduces the same batches.
+	 *
+	 * @see @ref update_image_loading()
+	 * @see @ref stop_image_loading_threads()
+	 *
+	 * @since 2026-10-18
+	 */
+	void start_image_loading(load_args args, const int prefetch_depth, uint64_t seed);
+
+
+	/** Called by the image loading threads for each new batch, in the order the batches will be used.  The first
+	 * parameter is the number of batches which come before this one.  The function may change the settings -- such as
+	 * the network dimensions -- used to load that batch.
+	 *
+	 * @since 2026-10-18
+	 */
+	using BatchSchedule = std::function<void(const size_t sequence, load_args & args)>;
+
+
+	/** Set the function which decides the settings for each batch.  This is how @p random=1 picks the network
+	 * dimensions ahead of time, so the batches are loaded at the size which will be used for training instead of being
+	 * discarded when the network is resized.  Must be called before @ref start_image_loading().
+	 *
+	 * @since 2026-10-18
+	 */
+	void set_training_batch_schedule(BatchSchedule schedule);
+
+
+	/** Change how the next batches are loaded, such as when the network dimensions change during training.  Batches
+	 * which were already queued with the old settings are discarded.
+	 *
+	 * @since 2026-10-18
+	 */
+	void update_image_loading(load_args args);
+
+
+	/** Get the oldest batch of training images.  This only blocks if the image loading threads have fallen behind and
+	 * no batch is ready.  The caller owns the returned data and must call @ref Darknet::free_data().  An empty batch
+	 * (zero rows) is returned if the image loading threads were stopped.
+	 *
+	 * @since 2026-10-18
+	 */
+	data get_next_training_batch();
+
+
+	/** This runs as a @p std::thread.  It is started by @ref start_image_loading() and keeps the queue of batches full
+	 * by handing out images to the permanent image loading threads.
 	 *
 	 * This was originally called @p load_threads() and used @p pthread, but has since been re-written to use C++11.
 	 *
@@ -27,10 +86,11 @@ namespace Darknet
 	 *
 	 * @since 2024-03-31
 	 */
-	void run_image_loading_control_thread(load_args args);
+	void run_image_loading_control_thread();
 
 
-	/** Stop and join the image loading threads started in @ref Darknet::run_image_loading_control_thread().
+	/** Stop and join the image loading threads started in @ref Darknet::start_image_loading().  Batches which have not
+	 * been returned by @ref get_next_training_batch() are freed.
 	 *
 	 * This was originally called @p free_load_threads() and used @p pthread, but has since been re-written to use C++11.
 	 *
@@ -39,22 +99,76 @@ namespace Darknet
 	void stop_image_loading_threads();
 
 
-	/** Run the permanent thread image loading loop.  This is started by @ref Darknet::run_image_loading_control_thread(),
-	 * and is stopped by @ref Darknet::stop_image_loading_threads().
+	/** Run the permanent thread image loading loop.  This is started by @ref Darknet::start_image_loading(), and is
+	 * stopped by @ref Darknet::stop_image_loading_threads().  Each thread waits for tasks to be queued by the control
+	 * thread, which is typically a single image (or a pair of images for contrastive learning).
 	 *
 	 * This was originally called @p run_thread_loop() and used @p pthread, but has since been re-written to use C++11.
 	 *
 	 * @since 2024-04-02
 	 */
-	void image_loading_loop(const int idx, load_args args);
+	void image_loading_loop(const int idx);
+
+
+	/** The fraction of time -- from @p 0.0 to @p 1.0 -- the image loading threads spent loading images between the 2
+	 * most recent calls to @ref get_next_training_batch().  A value close to @p 1.0 means the threads never ran out of
+	 * work, and more threads may be needed to keep the GPU busy.
+	 *
+	 * @since 2026-10-18
+	 */
+	float image_loading_utilisation();
+
+
+	/** The parts of loading a training image which are timed separately.
+	 * @see @ref LoaderStageTimer
+	 * @see @ref loader_stage_nanoseconds()
+	 * @since 2026-10-18
+	 */
+	enum class ELoaderStage
+	{
+		kDecode,		///< decoding the image file, or getting it from the packed dataset
+		kLabels,		///< reading and adjusting the bounding boxes
+		kAugment,		///< crop, resize, flip, blur, and noise, including @ref kColour
+		kColour,		///< hue, saturation, and exposure
+		kBlend,			///< combining the images for mosaic and mixup, including the conversion to float
+		kBatch,			///< moving the images into the batch
+		kMax
+	};
+
+
+	/** Measure how long it takes to run a part of the image loading.  The time is added to the total for that stage
+	 * when the object goes out of scope.
+	 *
+	 * @since 2026-10-18
+	 */
+	class LoaderStageTimer final
+	{
+		public:
+
+			LoaderStageTimer(const ELoaderStage s);
+			~LoaderStageTimer();
+
+		private:
+
+			const ELoaderStage stage;
+			const std::chrono::high_resolution_clock::time_point timestamp;
+	};
+
+
+	/** Total time in nanoseconds spent by all the image loading threads in each @ref ELoaderStage.  If @p reset is set,
+	 * the totals are cleared after they have been read.
+	 *
+	 * @since 2026-10-18
+	 */
+	std::vector<uint64_t> loader_stage_nanoseconds(const bool reset);
 
 
 	/** Load the given image data as described by the @p load_args parameter.  This is typically used to load images on a
 	 * secondary thread, such as @ref image_loading_loop().
 	 *
 	 * @note The name is misleading.  While I initially thought a single image at a time was being loaded, the @p args.n
-	 * argument is used to describe the number of images that will be loaded together.  This will typically be the batch
-	 * size divided by the number of worker threads (default is 6 threads).
+	 * argument is used to describe the number of images that will be loaded together.  This is typically @p 1 image,
+	 * but when tracking it is the batch size divided by the number of sequences.
 	 *
 	 * This was originally called @p load_thread().
 	 *
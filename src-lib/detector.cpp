@@ -14,6 +14,92 @@ typedef __compar_fn_t comparison_fn_t;
 namespace
 {
 	static auto & cfg_and_state = Darknet::CfgAndState::get();
+
+
+	/// Find the last YOLO or REGION layer, which is where the training settings such as @p jitter are stored.
+	static inline Darknet::Layer get_detection_layer(const Darknet::Network & net)
+	{
+		TAT(TATPARMS);
+
+		Darknet::Layer l = net.layers[net.n - 1];
+		for (int k = 0; k < net.n; ++k)
+		{
+			const Darknet::Layer & lk = net.layers[k];
+			if (lk.type == Darknet::ELayerType::YOLO or
+				lk.type == Darknet::ELayerType::GAUSSIAN_YOLO or
+				lk.type == Darknet::ELayerType::REGION)
+			{
+				l = lk;
+				std::cout << "Detection layer #" << k << " is type " << static_cast<int>(l.type) << " (" << Darknet::to_string(l.type) << ")" << std::endl;
+			}
+		}
+
+		return l;
+	}
+
+
+	/// Get the settings used by the image loading threads, such as the augmentation options from the .cfg file.
+	static inline load_args get_detection_load_args(const Darknet::Network & net, const Darknet::Layer & l, char ** paths, const int number_of_paths, const int imgs, const int ngpus)
+	{
+		TAT(TATPARMS);
+
+		load_args args = { 0 };
+		args.w = net.w;
+		args.h = net.h;
+		args.c = net.c;
+		args.paths = paths;
+		args.n = imgs;
+		args.m = number_of_paths;
+		args.classes = l.classes;
+		args.flip = net.flip;
+		args.jitter = l.jitter;
+		args.resize = l.resize;
+		args.num_boxes = l.max_boxes;
+		args.truth_size = l.truth_size;
+		args.type = DETECTION_DATA; // this is the only place in the code where this type is used
+		args.threads = 64;    // 16 or 64 -- see several lines below where this is set to 6 * GPUs
+
+		args.angle = net.angle;
+		args.gaussian_noise = net.gaussian_noise;
+		args.blur = net.blur;
+		args.mixup = net.mixup;
+		args.exposure = net.exposure;
+		args.saturation = net.saturation;
+		args.hue = net.hue;
+		args.letter_box = net.letter_box;
+		args.mosaic_bound = net.mosaic_bound;
+		args.contrastive = net.contrastive;
+		args.contrastive_jit_flip = net.contrastive_jit_flip;
+		args.contrastive_color = net.contrastive_color;
+
+		//int num_threads = get_num_threads();
+		//if(num_threads > 2) args.threads = get_num_threads() - 2;
+		args.threads = 6 * ngpus;   // 3 for - Amazon EC2 Tesla V100: p3.2xlarge (8 logical cores) - p3.16xlarge
+		//args.threads = 12 * ngpus;    // Ryzen 7 2700X (16 logical cores)
+
+		if (net.contrastive && args.threads > net.batch/2)
+		{
+			args.threads = net.batch / 2;
+		}
+
+		if (net.track)
+		{
+			args.track = net.track;
+			args.augment_speed = net.augment_speed;
+			if (net.sequential_subdivisions)
+			{
+				args.threads = net.sequential_subdivisions * ngpus;
+			}
+			else
+			{
+				args.threads = net.subdivisions * ngpus;
+			}
+			args.mini_batch = net.batch / net.time_steps;
+			printf("\n Tracking! batch = %d, subdiv = %d, time_steps = %d, mini_batch = %d \n", net.batch, net.subdivisions, net.time_steps, args.mini_batch);
+		}
+
+		return args;
+	}
 }
 
 static int coco_ids[] = { 1,2,3,4,5,6,7,8,9,10,11,13,14,15,16,17,18,19,20,21,22,23,24,25,27,28,31,32,33,34,35,36,37,38,39,40,41,42,43,44,46,47,48,49,50,51,52,53,54,55,56,57,58,59,60,61,62,63,64,65,67,70,72,73,74,75,76,77,78,79,80,81,82,84,85,86,87,88,89,90 };
@@ -104,25 +190,30 @@ void train_detector(const char * datacfg, const char * cfgfile, const char * wei
 	int imgs = net.batch * net.subdivisions * ngpus;
 	printf("Learning Rate: %g, Momentum: %g, Decay: %g\n", net.learning_rate, net.momentum, net.decay);
 	data train;
-	data buffer;
 
-	Darknet::Layer l = net.layers[net.n - 1];
-	for (int k = 0; k < net.n; ++k)
+	Darknet::Layer l = get_detection_layer(net);
+
+	// a seed of zero means a new random seed is used every time
+	uint64_t seed = cfg_and_state.get("seed", 0);
+	if (seed == 0)
 	{
-		Darknet::Layer & lk = net.layers[k];
-		if (lk.type == Darknet::ELayerType::YOLO or
-			lk.type == Darknet::ELayerType::GAUSSIAN_YOLO or
-			lk.type == Darknet::ELayerType::REGION)
-		{
-			l = lk;
-			std::cout << "Detection layer #" << k << " is type " << static_cast<int>(l.type) << " (" << Darknet::to_string(l.type) << ")" << std::endl;
-		}
+		seed = std::random_device{}();
 	}
 
-	int classes = l.classes;
-
 	list *plist = get_paths(train_images);
 	int train_images_num = plist->size;
+
+	// if the list contains .tar shards then the images are streamed from those files
+	const bool streaming = Darknet::open_streaming_dataset(train_images, seed, cfg_and_state.get("shufflebuffer", 2000));
+	if (streaming)
+	{
+		if (net.track)
+		{
+			darknet_fatal_error(DARKNET_LOC, "tracking needs the images in sequence and cannot use .tar shards");
+		}
+		train_images_num = Darknet::streaming_dataset_size();
+	}
+
 	if (train_images_num == 0)
 	{
 		darknet_fatal_error(DARKNET_LOC, "no training images available (verify %s)", train_images);
@@ -134,6 +225,13 @@ void train_detector(const char * datacfg, const char * cfgfile, const char * wei
 
 	char **paths = (char **)list_to_array(plist);
 
+	if (not streaming)
+	{
+		// if "darknet detector pack" was used, the images no longer need to be decoded while training
+		Darknet::open_packed_dataset(train_images);
+		Darknet::load_label_cache(train_images);
+	}
+
 	const int calc_map_for_each = fmax(100, train_images_num / (net.batch * net.subdivisions));  // calculate mAP for each epoch (used to be every 4 epochs)
 	printf("mAP calculations will be every %d iterations\n", calc_map_for_each);
 
@@ -151,72 +249,73 @@ void train_detector(const char * datacfg, const char * cfgfile, const char * wei
 	float mean_average_precision = -1;
 	float best_map = mean_average_precision;
 
-	load_args args = { 0 };
-	args.w = net.w;
-	args.h = net.h;
-	args.c = net.c;
-	args.paths = paths;
-	args.n = imgs;
-	args.m = plist->size;
-	args.classes = classes;
-	args.flip = net.flip;
-	args.jitter = l.jitter;
-	args.resize = l.resize;
-	args.num_boxes = l.max_boxes;
-	args.truth_size = l.truth_size;
+	load_args args = get_detection_load_args(net, l, paths, plist->size, imgs, ngpus);
 	net.num_boxes = args.num_boxes;
 	net.train_images_num = train_images_num;
-	args.d = &buffer;
-	args.type = DETECTION_DATA; // this is the only place in the code where this type is used
-	args.threads = 64;    // 16 or 64 -- see several lines below where this is set to 6 * GPUs
-
-	args.angle = net.angle;
-	args.gaussian_noise = net.gaussian_noise;
-	args.blur = net.blur;
-	args.mixup = net.mixup;
-	args.exposure = net.exposure;
-	args.saturation = net.saturation;
-	args.hue = net.hue;
-	args.letter_box = net.letter_box;
-	args.mosaic_bound = net.mosaic_bound;
-	args.contrastive = net.contrastive;
-	args.contrastive_jit_flip = net.contrastive_jit_flip;
-	args.contrastive_color = net.contrastive_color;
 	if (dont_show && show_imgs) show_imgs = 2;
 	args.show_imgs = show_imgs;
 
-	//int num_threads = get_num_threads();
-	//if(num_threads > 2) args.threads = get_num_threads() - 2;
-	args.threads = 6 * ngpus;   // 3 for - Amazon EC2 Tesla V100: p3.2xlarge (8 logical cores) - p3.16xlarge
-	//args.threads = 12 * ngpus;    // Ryzen 7 2700X (16 logical cores)
-
 	// This is where we draw the initial blank chart.  That chart is then updated by update_train_loss_chart() at every iteration.
 	Darknet::initialize_new_charts(net);
 
-	if (net.contrastive && args.threads > net.batch/2)
-	{
-		args.threads = net.batch / 2;
-	}
+	if (l.random)
+	{
+		/* Decide ahead of time which network dimensions will be used for each batch.  This way the images are always
+		 * loaded at the size the network will have when they are used, and no batch needs to be thrown away when the
+		 * network is resized.  The random values come from the seed, so the schedule is the same every time it is
+		 * called for a given batch.
+		 */
+		const float rand_coef			= (l.random != 1.0 ? l.random : 1.4f);
+		const int start_iteration		= get_current_iteration(net);
+		const int resize_step			= net.resize_step;
+		const int max_batches			= net.max_batches;
+		const int dynamic_minibatch		= net.dynamic_minibatch;
+		const int images_per_batch		= net.subdivisions * ngpus;
+		const int max_dim_w				= roundl(rand_coef*init_w / resize_step + 1) * resize_step;
+		const int max_dim_h				= roundl(rand_coef*init_h / resize_step + 1) * resize_step;
+
+		Darknet::set_training_batch_schedule(
+			[=](const size_t sequence, load_args & batch_args)
+			{
+				// the network is resized every 10 iterations
+				const size_t resize_sequence = sequence - sequence % 10;
 
-	if (net.track)
-	{
-		args.track = net.track;
-		args.augment_speed = net.augment_speed;
-		if (net.sequential_subdivisions)
-		{
-			args.threads = net.sequential_subdivisions * ngpus;
-		}
-		else
-		{
-			args.threads = net.subdivisions * ngpus;
-		}
-		args.mini_batch = net.batch / net.time_steps;
-		printf("\n Tracking! batch = %d, subdiv = %d, time_steps = %d, mini_batch = %d \n", net.batch, net.subdivisions, net.time_steps, args.mini_batch);
-	}
+				set_rng_stream(~seed, resize_sequence);
+				const float random_val = rand_scale(rand_coef);    // *x or /x
+				clear_rng_stream();
+
+				int dim_w = roundl(random_val*init_w / resize_step + 1) * resize_step;
+				int dim_h = roundl(random_val*init_h / resize_step + 1) * resize_step;
+				if (random_val < 1 && (dim_w > init_w || dim_h > init_h))
+				{
+					dim_w = init_w, dim_h = init_h;
+				}
 
-	std::thread load_thread = std::thread(Darknet::run_image_loading_control_thread, args);
+				// at the beginning (check if enough memory) and at the end (calc rolling mean/variance)
+				if (resize_sequence == 0 || start_iteration + static_cast<int>(resize_sequence) > max_batches - 100)
+				{
+					dim_w = max_dim_w;
+					dim_h = max_dim_h;
+				}
+
+				if (dim_w < resize_step) dim_w = resize_step;
+				if (dim_h < resize_step) dim_h = resize_step;
+
+				batch_args.w = dim_w;
+				batch_args.h = dim_h;
+
+				if (dynamic_minibatch)
+				{
+					int dim_b = (init_b * max_dim_w * max_dim_h) / (dim_w * dim_h);
+					int new_dim_b = (int)(dim_b * 0.8);
+					if (new_dim_b > init_b) dim_b = new_dim_b;
+					batch_args.n = dim_b * images_per_batch;
+				}
+			});
+	}
 
-	int count = 0;
+	// load several batches ahead of time so a single slow batch does not stall training
+	Darknet::start_image_loading(args, cfg_and_state.get("prefetch", 3), seed);
 
 	const std::time_t start_of_training = std::time(nullptr);
 
@@ -230,45 +329,26 @@ void train_detector(const char * datacfg, const char * cfgfile, const char * wei
 		std::cout << std::endl;
 		errno = 0;
 
+		double time = what_time_is_it_now();
+		train = Darknet::get_next_training_batch();
+		if (train.X.rows == 0)
+		{
+			// the image loading threads have been stopped
+			break;
+		}
+
 		// yolov3-tiny, yolov3-tiny-3l, yolov3, and yolov4 all use "random=1"
 		// yolov4-tiny and yolov4-tiny-3l both use "random=0"
-		if (l.random && count++ % 10 == 0)
+		if (train.w != net.w || train.h != net.h || train.X.rows != imgs)
 		{
-			float rand_coef = 1.4;
-			if (l.random != 1.0)
-			{
-				rand_coef = l.random;
-			}
-			printf("Resizing, random_coef = %.2f \n", rand_coef);
-			float random_val = rand_scale(rand_coef);    // *x or /x
-			int dim_w = roundl(random_val*init_w / net.resize_step + 1) * net.resize_step;
-			int dim_h = roundl(random_val*init_h / net.resize_step + 1) * net.resize_step;
-			if (random_val < 1 && (dim_w > init_w || dim_h > init_h))
-			{
-				dim_w = init_w, dim_h = init_h;
-			}
-
-			int max_dim_w = roundl(rand_coef*init_w / net.resize_step + 1) * net.resize_step;
-			int max_dim_h = roundl(rand_coef*init_h / net.resize_step + 1) * net.resize_step;
-
-			// at the beginning (check if enough memory) and at the end (calc rolling mean/variance)
-			if (avg_loss < 0.0f || get_current_iteration(net) > net.max_batches - 100)
-			{
-				dim_w = max_dim_w;
-				dim_h = max_dim_h;
-			}
-
-			if (dim_w < net.resize_step) dim_w = net.resize_step;
-			if (dim_h < net.resize_step) dim_h = net.resize_step;
-			int dim_b = (init_b * max_dim_w * max_dim_h) / (dim_w * dim_h);
-			int new_dim_b = (int)(dim_b * 0.8);
-			if (new_dim_b > init_b) dim_b = new_dim_b;
-
-			args.w = dim_w;
-			args.h = dim_h;
+			// the batch was loaded for different network dimensions, see the schedule given to set_training_batch_schedule()
+			const int dim_w = train.w;
+			const int dim_h = train.h;
+			printf("Resizing to %d x %d\n", dim_w, dim_h);
 
 			if (net.dynamic_minibatch)
 			{
+				const int dim_b = train.X.rows / (net.subdivisions * ngpus);
 				for (int k = 0; k < ngpus; ++k)
 				{
 					(*nets[k].seen) = init_b * net.subdivisions * get_current_iteration(net); // remove this line, when you will save to weights-file both: seen & cur_iteration
@@ -281,7 +361,6 @@ void train_detector(const char * datacfg, const char * cfgfile, const char * wei
 				}
 				net.batch = dim_b;
 				imgs = net.batch * net.subdivisions * ngpus;
-				args.n = imgs;
 				printf("\n %d x %d  (batch = %d) \n", dim_w, dim_h, net.batch);
 			}
 			else
@@ -289,34 +368,27 @@ void train_detector(const char * datacfg, const char * cfgfile, const char * wei
 				printf("\n %d x %d \n", dim_w, dim_h);
 			}
 
-			load_thread.join();
-			train = buffer;
-			Darknet::free_data(train);
-
-			load_thread = std::thread(Darknet::run_image_loading_control_thread, args);
-
 			for (int k = 0; k < ngpus; ++k)
 			{
 				resize_network(nets + k, dim_w, dim_h);
 			}
 			net = nets[0];
-		} // random=1
-
-		double time = what_time_is_it_now();
-		load_thread.join();
-		train = buffer;
+		}
 		if (net.track)
 		{
 			net.sequential_subdivisions = get_current_seq_subdivisions(net);
-			args.threads = net.sequential_subdivisions * ngpus;
+			if (args.threads != net.sequential_subdivisions * ngpus)
+			{
+				args.threads = net.sequential_subdivisions * ngpus;
+				Darknet::update_image_loading(args);
+			}
 			printf(" sequential_subdivisions = %d, sequence = %d \n", net.sequential_subdivisions, get_sequence_value(net));
 		}
-		load_thread = std::thread(Darknet::run_image_loading_control_thread, args);
 
 		const double load_time = (what_time_is_it_now() - time);
 		if (cfg_and_state.is_verbose)
 		{
-			std::cout << "loaded " << args.n << " images in " << Darknet::format_time(load_time) << std::endl;
+			std::cout << "loaded " << train.X.rows << " images in " << Darknet::format_time(load_time) << " (image loading threads were busy " << static_cast<int>(std::round(100.0f * Darknet::image_loading_utilisation())) << "% of the time)" << std::endl;
 		}
 		if (load_time > 0.1 && avg_loss > 0.0f)
 		{
@@ -416,9 +488,8 @@ void train_detector(const char * datacfg, const char * cfgfile, const char * wei
 		{
 			if (l.random)
 			{
+				// the next batch is still loaded for the scheduled dimensions, so the training loop will resize again
 				printf("Resizing to initial size: %d x %d ", init_w, init_h);
-				args.w = init_w;
-				args.h = init_h;
 				if (net.dynamic_minibatch)
 				{
 					for (int k = 0; k < ngpus; ++k)
@@ -431,13 +502,8 @@ void train_detector(const char * datacfg, const char * cfgfile, const char * wei
 					}
 					net.batch = init_b;
 					imgs = init_b * net.subdivisions * ngpus;
-					args.n = imgs;
 					printf("\n %d x %d  (batch = %d) \n", init_w, init_h, init_b);
 				}
-				load_thread.join();
-				Darknet::free_data(train);
-				train = buffer;
-				load_thread = std::thread(Darknet::run_image_loading_control_thread, args);
 
 				for (int k = 0; k < ngpus; ++k)
 				{
@@ -530,10 +596,9 @@ void train_detector(const char * datacfg, const char * cfgfile, const char * wei
 	cv::destroyAllWindows();
 
 	// free memory
-	load_thread.join();
-	Darknet::free_data(buffer);
-
 	Darknet::stop_image_loading_threads();
+	Darknet::close_packed_dataset();
+	Darknet::close_streaming_dataset();
 
 	free((void*)base);
 	free(paths);
@@ -993,6 +1058,7 @@ void validate_detector_recall(char *datacfg, char *cfgfile, char *weightfile)
 	const char *valid_images = option_find_str(options, "valid", "data/train.txt");
 	list *plist = get_paths(valid_images);
 	char **paths = (char **)list_to_array(plist);
+	Darknet::load_label_cache(valid_images);
 
 	//layer l = net.layers[net.n - 1];
 
@@ -1022,11 +1088,8 @@ void validate_detector_recall(char *datacfg, char *cfgfile, char *weightfile)
 		Darknet::Detection * dets = get_network_boxes(&net, sized.w, sized.h, thresh, .5, 0, 1, &nboxes, letterbox);
 		if (nms) do_nms_obj(dets, nboxes, 1, nms);
 
-		char labelpath[4096];
-		replace_image_to_label(path, labelpath);
-
 		int num_labels = 0;
-		box_label *truth = read_boxes(labelpath, &num_labels);
+		box_label *truth = read_boxes_for_image(path, &num_labels);
 		for (k = 0; k < nboxes; ++k) {
 			if (dets[k].objectness > thresh) {
 				++proposals;
@@ -1117,12 +1180,16 @@ float validate_detector_map(const char * datacfg, const char * cfgfile, const ch
 		Darknet::display_warning_msg("Warning: there seems to be very few validation images (num=" + std::to_string(plist->size) + ", batch=" + std::to_string(actual_batch_size) + ")\n");
 	}
 
+	// the annotations are read once here, instead of every time the mAP is calculated while training
+	Darknet::load_label_cache(valid_images);
+
 	list *plist_dif = NULL;
 	char **paths_dif = NULL;
 	if (difficult_valid_images)
 	{
 		plist_dif = get_paths(difficult_valid_images);
 		paths_dif = (char **)list_to_array(plist_dif);
+		Darknet::load_label_cache(difficult_valid_images);
 	}
 
 	Darknet::Layer l = net.layers[net.n - 1];
@@ -1253,10 +1320,8 @@ float validate_detector_map(const char * datacfg, const char * cfgfile, const ch
 				}
 			}
 
-			char labelpath[4096];
-			replace_image_to_label(path, labelpath);
 			int num_labels = 0;
-			box_label *truth = read_boxes(labelpath, &num_labels);
+			box_label *truth = read_boxes_for_image(path, &num_labels);
 			for (int j = 0; j < num_labels; ++j)
 			{
 				truth_classes_count[truth[j].id]++;
@@ -1269,10 +1334,7 @@ float validate_detector_map(const char * datacfg, const char * cfgfile, const ch
 			{
 				char *path_dif = paths_dif[image_index];
 
-				char labelpath_dif[4096];
-				replace_image_to_label(path_dif, labelpath_dif);
-
-				truth_dif = read_boxes(labelpath_dif, &num_labels_dif);
+				truth_dif = read_boxes_for_image(path_dif, &num_labels_dif);
 			}
 
 			const int checkpoint_detections_count = detections_count;
@@ -1738,6 +1800,7 @@ void calc_anchors(char *datacfg, int num_of_clusters, int width, int height, int
 	list *plist = get_paths(train_images);
 	int number_of_images = plist->size;
 	char **paths = (char **)list_to_array(plist);
+	Darknet::load_label_cache(train_images);
 
 	int classes = option_find_int(options, "classes", 1);
 	int* counter_per_class = (int*)xcalloc(classes, sizeof(int));
@@ -1753,7 +1816,7 @@ void calc_anchors(char *datacfg, int num_of_clusters, int width, int height, int
 		replace_image_to_label(path, labelpath);
 
 		int num_labels = 0;
-		box_label *truth = read_boxes(labelpath, &num_labels);
+		box_label *truth = read_boxes_for_image(path, &num_labels);
 		//printf(" new path: %s \n", labelpath);
 		char *buff = (char*)xcalloc(6144, sizeof(char));
 		for (j = 0; j < num_labels; ++j)
@@ -2098,6 +2161,142 @@ void test_detector(const char *datacfg, const char *cfgfile, const char *weightf
 }
 
 
+void loadbench_detector(const char * datacfg, const char * cfgfile)
+{
+	TAT(TATPARMS);
+
+	list * options = read_data_cfg(datacfg);
+	const char * train_images = option_find_str(options, "train", "data/train.txt");
+
+	// the network is only needed for the image size and the augmentation settings, it is never run
+	Darknet::Network net = parse_network_cfg(cfgfile);
+	const Darknet::Layer l = get_detection_layer(net);
+	const int imgs = net.batch * net.subdivisions;
+
+	uint64_t seed = cfg_and_state.get("seed", 0);
+	if (seed == 0)
+	{
+		seed = std::random_device{}();
+	}
+
+	list * plist = get_paths(train_images);
+	char ** paths = (char **)list_to_array(plist);
+
+	const bool streaming = Darknet::open_streaming_dataset(train_images, seed, cfg_and_state.get("shufflebuffer", 2000));
+	if (not streaming)
+	{
+		Darknet::open_packed_dataset(train_images);
+		Darknet::load_label_cache(train_images);
+	}
+	const int number_of_images = (streaming ? Darknet::streaming_dataset_size() : plist->size);
+	if (number_of_images == 0)
+	{
+		darknet_fatal_error(DARKNET_LOC, "no training images available (verify %s)", train_images);
+	}
+
+	load_args args = get_detection_load_args(net, l, paths, plist->size, imgs, 1);
+	const int threads = cfg_and_state.get("threads", 0);
+	if (threads > 0)
+	{
+		args.threads = threads;
+	}
+	const int batches = std::max(1, cfg_and_state.get_int("batches"));
+
+	std::cout
+		<< "Loading " << batches << " batches of " << imgs << " images at " << args.w << "x" << args.h
+		<< " using " << args.threads << " threads"
+		<< " (mosaic=" << args.mixup << ", letter_box=" << args.letter_box << ", contrastive=" << args.contrastive << ")" << std::endl;
+
+	Darknet::start_image_loading(args, cfg_and_state.get("prefetch", 3), seed);
+
+	// the first batch includes the time it takes to start the threads and fill the queue, so it is not measured
+	data d = Darknet::get_next_training_batch();
+	Darknet::free_data(d);
+	Darknet::loader_stage_nanoseconds(true);
+
+	float utilisation = 0.0f;
+	int batches_loaded = 0;
+	size_t images_loaded = 0;
+	const auto start = std::chrono::high_resolution_clock::now();
+	for (int idx = 0; idx < batches and cfg_and_state.must_immediately_exit == false; idx ++)
+	{
+		d = Darknet::get_next_training_batch();
+		if (d.X.rows == 0)
+		{
+			break;
+		}
+		batches_loaded ++;
+		images_loaded += d.X.rows;
+		utilisation += Darknet::image_loading_utilisation();
+		Darknet::free_data(d);
+	}
+	const auto end = std::chrono::high_resolution_clock::now();
+	const double seconds = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / 1000000000.0;
+
+	// get the totals before the threads are stopped, otherwise the prefetched batches would also be counted
+	const auto totals = Darknet::loader_stage_nanoseconds(true);
+	Darknet::stop_image_loading_threads();
+
+	const auto total_of = [&](const Darknet::ELoaderStage stage) -> double
+	{
+		return static_cast<double>(totals[static_cast<size_t>(stage)]);
+	};
+
+	// augmentation includes the colour changes, so remove it to get the time spent cropping and resizing
+	const std::vector<std::pair<std::string, double>> stages =
+	{
+		{"decode"		, total_of(Darknet::ELoaderStage::kDecode)},
+		{"crop/resize"	, std::max(0.0, total_of(Darknet::ELoaderStage::kAugment) - total_of(Darknet::ELoaderStage::kColour))},
+		{"colour"		, total_of(Darknet::ELoaderStage::kColour)},
+		{"mosaic blend"	, total_of(Darknet::ELoaderStage::kBlend)},
+		{"label fill"	, total_of(Darknet::ELoaderStage::kLabels)},
+		{"concat"		, total_of(Darknet::ELoaderStage::kBatch)},
+	};
+	double sum = 0.0;
+	for (const auto & [name, nanoseconds] : stages)
+	{
+		sum += nanoseconds;
+	}
+
+	std::cout
+		<< std::endl
+		<< "Loaded " << images_loaded << " images in " << Darknet::format_time(seconds)
+		<< " (" << std::fixed << std::setprecision(1) << (seconds > 0.0 ? images_loaded / seconds : 0.0) << " images/s)" << std::endl
+		<< "Time per image across all threads:" << std::endl;
+
+	for (const auto & [name, nanoseconds] : stages)
+	{
+		std::cout
+			<< "  " << std::left << std::setw(14) << name << std::right
+			<< std::setw(10) << std::setprecision(3) << (images_loaded ? nanoseconds / images_loaded / 1000000.0 : 0.0) << " ms"
+			<< std::setw(8) << std::setprecision(1) << (sum > 0.0 ? 100.0 * nanoseconds / sum : 0.0) << "%" << std::endl;
+	}
+
+	// the loop may have stopped early, so only average the batches which were actually loaded
+	const float average_utilisation = (batches_loaded > 0 ? utilisation / batches_loaded : 0.0f);
+	std::cout << "Image loading threads were busy " << std::setprecision(0) << 100.0f * average_utilisation << "% of the time" << std::endl;
+	if (batches_loaded > 0 and average_utilisation < 0.9f)
+	{
+		std::cout << "The image loading threads were often idle, so this run was limited by the main thread and not by the threads." << std::endl;
+	}
+	std::cout << std::defaultfloat;
+
+	Darknet::close_packed_dataset();
+	Darknet::close_streaming_dataset();
+
+	free(paths);
+	free_list_contents(plist);
+	free_list(plist);
+
+	free_list_contents_kvp(options);
+	free_list(options);
+
+	free_network(net);
+
+	return;
+}
+
+
 void run_detector(int argc, char **argv)
 {
 	TAT(TATPARMS);
@@ -2184,6 +2383,25 @@ void run_detector(int argc, char **argv)
 	else if (cfg_and_state.function == "valid"		) { validate_detector(datacfg, cfg, weights, outfile); }
 	else if (cfg_and_state.function == "recall"		) { validate_detector_recall(datacfg, cfg, weights); }
 	else if (cfg_and_state.function == "map"		) { validate_detector_map(datacfg, cfg, weights, thresh, iou_thresh, map_points, letter_box, NULL); }
+	else if (cfg_and_state.function == "loadbench"	)
+	{
+		if (datacfg == nullptr or cfg == nullptr)
+		{
+			darknet_fatal_error(DARKNET_LOC, "the .data and .cfg files are required to measure how fast training images are loaded");
+		}
+		loadbench_detector(datacfg, cfg);
+	}
+	else if (cfg_and_state.function == "pack"		)
+	{
+		const int max_side			= cfg_and_state.get_int	("maxside"		);
+		const int shard_size_mib	= cfg_and_state.get_int	("shardsize"	);
+
+		if (datacfg == nullptr)
+		{
+			darknet_fatal_error(DARKNET_LOC, "the .data file is required to pack the training images");
+		}
+		Darknet::pack_dataset(datacfg, max_side, shard_size_mib);
+	}
 	else if (cfg_and_state.function == "calcanchors")
 	{
 		const int show				= cfg_and_state.is_set	("show"			) ? 1 : 0;
@@ -1819,11 +1819,10 @@ void forward_maxpool_layer_avx(float *src, float *dst, int *indexes, int size, i
 
 	const int w_offset = -pad / 2;
 	const int h_offset = -pad / 2;
-	int b, k;
+	int b;
 
 	for (b = 0; b < batch; ++b) {
-		#pragma omp parallel for
-		for (k = 0; k < c; ++k) {
+		Darknet::parallel_for(0, c, [&](const int k) {
 			int i, j, m, n;
 			for (i = 0; i < out_h; ++i) {
 				//for (j = 0; j < out_w; ++j) {
@@ -1903,7 +1902,7 @@ void forward_maxpool_layer_avx(float *src, float *dst, int *indexes, int size, i
 					if (indexes) indexes[out_index] = max_i;
 				}
 			}
-		}
+		}, 1);
 	}
 }
 
@@ -1944,16 +1943,15 @@ void gemm_nn_fast(int M, int N, int K, float ALPHA,
 {
 	TAT(TATPARMS);
 
-	int i, j, k;
-	#pragma omp parallel for
-	for (i = 0; i < M; ++i) {
+	Darknet::parallel_for(0, M, [&](const int i) {
+		int j, k;
 		for (k = 0; k < K; ++k) {
 			PUT_IN_REGISTER float A_PART = ALPHA*A[i*lda + k];
 			for (j = 0; j < N; ++j) {
 				C[i*ldc + j] += A_PART*B[k*ldb + j];
 			}
 		}
-	}
+	}, 1);
 }
 
 void gemm_nn_bin_32bit_packed(int M, int N, int K, float ALPHA,
@@ -2386,13 +2384,12 @@ void forward_maxpool_layer_avx(float *src, float *dst, int *indexes, int size, i
 {
 	TAT(TATPARMS);
 
-	int b, k;
+	int b;
 	const int w_offset = -pad / 2;
 	const int h_offset = -pad / 2;
 
 	for (b = 0; b < batch; ++b) {
-		#pragma omp parallel for
-		for (k = 0; k < c; ++k) {
+		Darknet::parallel_for(0, c, [&](const int k) {
 			int i, j, m, n;
 			for (i = 0; i < out_h; ++i) {
 				for (j = 0; j < out_w; ++j) {
@@ -2415,7 +2412,7 @@ void forward_maxpool_layer_avx(float *src, float *dst, int *indexes, int size, i
 					if (indexes) indexes[out_index] = max_i;
 				}
 			}
-		}
+		}, 1);
 	}
 }
 
@@ -2640,9 +2637,7 @@ void gemm_cpu(int TA, int TB, int M, int N, int K, float ALPHA,
 		gemm_nn_fast(M, N, K, ALPHA, A, lda, B, ldb, C, ldc);
 	}
 	else {
-		int t;
-		#pragma omp parallel for
-		for (t = 0; t < M; ++t) {
+		Darknet::parallel_for(0, M, [&](const int t) {
 			if (!TA && !TB)
 				gemm_nn(1, N, K, ALPHA, A + t*lda, lda, B, ldb, C + t*ldc, ldc);
 			else if (TA && !TB)
@@ -2651,7 +2646,7 @@ void gemm_cpu(int TA, int TB, int M, int N, int K, float ALPHA,
 				gemm_nt(1, N, K, ALPHA, A + t*lda, lda, B, ldb, C + t*ldc, ldc);
 			else
 				gemm_tt(1, N, K, ALPHA, A + t, lda, B, ldb, C + t*ldc, ldc);
-		}
+		}, 1);
 	}
 }
 
@@ -34,50 +34,94 @@
 #endif
 
 
-cv::Mat load_rgb_mat_image(const char * const filename, int channels)
+namespace
 {
-	TAT(TATPARMS);
-
-	if (filename == nullptr or
-		filename[0] == '\0')
+	/// Get the OpenCV flag needed to read an image with the given number of channels.
+	static inline cv::ImreadModes imread_flag(int channels, const char * const filename)
 	{
-		darknet_fatal_error(DARKNET_LOC, "cannot load an image without a filename");
-	}
+		TAT(TATPARMS);
 
-	auto flag = cv::IMREAD_UNCHANGED;
+		auto flag = cv::IMREAD_UNCHANGED;
 
-	if (channels == 1)
-	{
-		flag = cv::IMREAD_GRAYSCALE;
+		if (channels == 1)
+		{
+			flag = cv::IMREAD_GRAYSCALE;
+		}
+		else if (channels == 3)
+		{
+			flag = cv::IMREAD_COLOR;
+		}
+		else if (channels != 0)
+		{
+			darknet_fatal_error(DARKNET_LOC, "OpenCV cannot load an image with %d channels: %s", channels, filename);
+		}
+
+		return flag;
 	}
-	else if (channels == 3)
+
+
+	/// Convert the image read by OpenCV from BGR to RGB.
+	static inline void bgr_to_rgb(cv::Mat & mat, int channels)
 	{
-		flag = cv::IMREAD_COLOR;
+		TAT(TATPARMS);
+
+		if (mat.channels() == 3)
+		{
+			cv::cvtColor(mat, mat, cv::COLOR_BGR2RGB);
+		}
+		else if (mat.channels() == 4 and channels == 3)
+		{
+			cv::cvtColor(mat, mat, cv::COLOR_BGRA2RGB);
+		}
+		else if (mat.channels() == 4)
+		{
+			cv::cvtColor(mat, mat, cv::COLOR_BGRA2RGBA);
+		}
+
+		return;
 	}
-	else if (channels != 0)
+}
+
+
+cv::Mat load_rgb_mat_image(const char * const filename, int channels, const cv::Size & minimum_size)
+{
+	TAT(TATPARMS);
+
+	if (filename == nullptr or
+		filename[0] == '\0')
 	{
-		darknet_fatal_error(DARKNET_LOC, "OpenCV cannot load an image with %d channels: %s", channels, filename);
+		darknet_fatal_error(DARKNET_LOC, "cannot load an image without a filename");
 	}
 
-	cv::Mat mat = cv::imread(filename, flag);
+	const auto flag = imread_flag(channels, filename);
+
+	cv::Size original_size;
+	cv::Mat mat = Darknet::load_mat_image_scaled(filename, minimum_size, original_size, flag);
 	if (mat.empty())
 	{
 		darknet_fatal_error(DARKNET_LOC, "failed to load image file \"%s\"", filename);
 	}
 
-	if (mat.channels() == 3)
-	{
-		cv::cvtColor(mat, mat, cv::COLOR_BGR2RGB);
-	}
-	else if (mat.channels() == 4 and channels == 3)
-	{
-		cv::cvtColor(mat, mat, cv::COLOR_BGRA2RGB);
-	}
-	else if (mat.channels() == 4)
+	bgr_to_rgb(mat, channels);
+
+	return mat;
+}
+
+
+cv::Mat decode_rgb_mat_image(const std::vector<uint8_t> & buffer, int channels, const char * const name)
+{
+	TAT(TATPARMS);
+
+	const auto flag = imread_flag(channels, name);
+
+	cv::Mat mat = cv::imdecode(buffer, flag);
+	if (mat.empty())
 	{
-		cv::cvtColor(mat, mat, cv::COLOR_BGRA2RGBA);
+		darknet_fatal_error(DARKNET_LOC, "failed to decode image \"%s\"", name);
 	}
 
+	bgr_to_rgb(mat, channels);
+
 	return mat;
 }
 
@@ -293,6 +337,50 @@ void draw_detections_cv_v3(cv::Mat mat, Darknet::Detection * dets, int num, floa
 // ====================================================================
 
 
+void hsv_jitter(cv::Mat & mat, float dhue, float dsat, float dexp)
+{
+	TAT(TATPARMS);
+
+	if (dsat == 1 && dexp == 1 && dhue == 0)
+	{
+		return;
+	}
+
+	Darknet::LoaderStageTimer timer(Darknet::ELoaderStage::kColour);
+
+	/* The lookup table only has 256 entries, so it costs almost nothing to build even though the values are different
+	 * for every image.  The table is built with the same integer rounding regardless of the CPU, so the results are the
+	 * same everywhere for a given set of random values.
+	 */
+	cv::Mat lut(1, 256, CV_8UC3);
+	const int hue_shift = cvRound(179.0f * dhue);	// OpenCV uses 0-179 for the hue of 8-bit images
+	for (int idx = 0; idx < 256; idx ++)
+	{
+		lut.at<cv::Vec3b>(idx) = cv::Vec3b(
+			(idx + hue_shift + 180 * 2) % 180,
+			cv::saturate_cast<uint8_t>(idx * dsat),
+			cv::saturate_cast<uint8_t>(idx * dexp));
+	}
+
+	if (mat.channels() == 3)
+	{
+		cv::Mat hsv;
+		cv::cvtColor(mat, hsv, cv::COLOR_RGB2HSV);
+		cv::LUT(hsv, lut, hsv);
+		cv::cvtColor(hsv, mat, cv::COLOR_HSV2RGB);
+	}
+	else
+	{
+		/// @todo COLOR - only exposure is applied to images which are not RGB
+		std::vector<cv::Mat> channels;
+		cv::split(lut, channels);
+		cv::LUT(mat, channels[2], mat);
+	}
+
+	return;
+}
+
+
 /// @todo COLOR - cannot do hue in hyperspectal land
 Darknet::Image image_data_augmentation(cv::Mat mat, int w, int h,
 	int pleft, int ptop, int swidth, int sheight, int flip,
@@ -336,30 +424,7 @@ Darknet::Image image_data_augmentation(cv::Mat mat, int w, int h,
 		}
 
 		// HSV augmentation
-		// cv::COLOR_BGR2HSV, cv::COLOR_RGB2HSV, cv::COLOR_HSV2BGR, cv::COLOR_HSV2RGB
-		if (dsat != 1 || dexp != 1 || dhue != 0)
-		{
-			if (mat.channels() >= 3)	// This only (really) works for c == 3
-			{
-				cv::Mat hsv_src;
-				cvtColor(sized, hsv_src, cv::COLOR_RGB2HSV);    // RGB to HSV
-
-				std::vector<cv::Mat> hsv;
-				cv::split(hsv_src, hsv);
-
-				hsv[1] *= dsat;
-				hsv[2] *= dexp;
-				hsv[0] += 179 * dhue;
-
-				cv::merge(hsv, hsv_src);
-
-				cvtColor(hsv_src, sized, cv::COLOR_HSV2RGB);    // HSV to RGB (the same as previous)
-			}
-			else
-			{
-				sized *= dexp;
-			}
-		}
+		hsv_jitter(sized, dhue, dsat, dexp);
 
 		//std::stringstream window_name;
 		//window_name << "augmentation - " << ipl;
@@ -440,6 +505,88 @@ Darknet::Image image_data_augmentation(cv::Mat mat, int w, int h,
 }
 
 
+void mosaic_data_augmentation(const cv::Mat & mat, cv::Mat & canvas, const cv::Rect & quadrant, const cv::Point & offset,
+	int w, int h, int pleft, int ptop, int swidth, int sheight, int flip,
+	float dhue, float dsat, float dexp,
+	int gaussian_noise, int blur, int num_boxes, int truth_size, float *truth)
+{
+	TAT(TATPARMS);
+
+	if (quadrant.empty())
+	{
+		return;
+	}
+
+	try
+	{
+		cv::Mat dst = canvas(quadrant);
+
+		/* Crop, resize, and flip in a single pass.  This maps each pixel of the quadrant back to the source image using
+		 * the same pixel centres as cv::resize(..., cv::INTER_LINEAR), and anything outside of the source image gets
+		 * the average colour exactly like the crop done in image_data_augmentation().
+		 */
+		const double scale_x = static_cast<double>(swidth) / w;
+		const double scale_y = static_cast<double>(sheight) / h;
+		cv::Matx23d m(
+			scale_x, 0.0, scale_x * (offset.x + 0.5) - 0.5 + pleft,
+			0.0, scale_y, scale_y * (offset.y + 0.5) - 0.5 + ptop);
+		if (flip)
+		{
+			m(0, 0) = -scale_x;
+			m(0, 2) = scale_x * (w - 0.5 - offset.x) - 0.5 + pleft;
+		}
+		cv::warpAffine(mat, dst, m, quadrant.size(), cv::INTER_LINEAR | cv::WARP_INVERSE_MAP, cv::BORDER_CONSTANT, cv::mean(mat));
+
+		hsv_jitter(dst, dhue, dsat, dexp);
+
+		if (blur)
+		{
+			const int ksize = (blur == 1 ? 17 : (blur / 2) * 2 + 1);
+			cv::Mat blurred;
+			cv::GaussianBlur(dst, blurred, cv::Size(ksize, ksize), 0);
+
+			if (blur == 1)
+			{
+				// only blur the background, so copy the objects back into the blurred image
+				const cv::Rect r(0, 0, dst.cols, dst.rows);
+				for (int t = 0; t < num_boxes; ++t)
+				{
+					Darknet::Box b = float_to_box_stride(truth + t*truth_size, 1);
+					if (!b.x) break;
+					const int left = (b.x - b.w / 2.)*w - offset.x;
+					const int top = (b.y - b.h / 2.)*h - offset.y;
+					cv::Rect roi(left, top, b.w*w, b.h*h);
+					roi = roi & r;
+
+					dst(roi).copyTo(blurred(roi));
+				}
+			}
+			blurred.copyTo(dst);
+		}
+
+		if (gaussian_noise)
+		{
+			gaussian_noise = std::min(gaussian_noise, 127);
+			gaussian_noise = std::max(gaussian_noise, 0);
+			// same as image_data_augmentation():  the noise is generated as 8-bit, so only the positive half is added
+			cv::Mat noise(dst.size(), dst.type());
+			cv::randn(noise, 0, gaussian_noise);
+			dst += noise;
+		}
+	}
+	catch (const std::exception & e)
+	{
+		darknet_fatal_error(DARKNET_LOC, "exception caught while creating mosaic (%dx%d): %s", w, h, e.what());
+	}
+	catch (...)
+	{
+		darknet_fatal_error(DARKNET_LOC, "unknown exception while creating mosaic (%dx%d)", w, h);
+	}
+
+	return;
+}
+
+
 // blend two images with (alpha and beta)
 void blend_images_cv(Darknet::Image new_img, float alpha, Darknet::Image old_img, float beta)
 {
@@ -6,21 +6,49 @@
 /** Load the given image using OpenCV.  Automatically converts the image from the usual OpenCV BGR format to RGB for
  * use in Darknet.
  *
+ * If @p minimum_size is set, large JPEG images may be decoded at a reduced size which is still at least that large.
+ * @see @ref Darknet::load_mat_image_scaled()
+ *
  * @see @ref Darknet::load_image()
  */
-cv::Mat load_rgb_mat_image(const char * const filename, int flag);
+cv::Mat load_rgb_mat_image(const char * const filename, int flag, const cv::Size & minimum_size = cv::Size());
+
+/** Similar to @ref load_rgb_mat_image(), but the image is decoded from memory, such as an image read from a @p .tar
+ * file.  The @p name is only used for error messages.
+ *
+ * @since 2026-10-18
+ */
+cv::Mat decode_rgb_mat_image(const std::vector<uint8_t> & buffer, int channels, const char * const name);
 
 void show_image_cv(Darknet::Image p, const char *name);
 
 // Draw Detection
 void draw_detections_cv_v3(cv::Mat show_img, Darknet::Detection *dets, int num, float thresh, char **names, int classes, int ext_output);
 
+/** Apply the random hue, saturation, and exposure to an 8-bit RGB image using lookup tables.  Images which are not
+ * 3-channel only have the exposure applied.
+ *
+ * @since 2026-10-18
+ */
+void hsv_jitter(cv::Mat & mat, float dhue, float dsat, float dexp);
+
 // Data augmentation
 Darknet::Image image_data_augmentation(cv::Mat mat, int w, int h,
     int pleft, int ptop, int swidth, int sheight, int flip,
     float dhue, float dsat, float dexp,
     int gaussian_noise, int blur, int num_boxes, int truth_size, float *truth);
 
+/** Similar to @ref image_data_augmentation(), but used for mosaic.  Instead of creating a new @p w x @p h image, only
+ * the @p quadrant of the 8-bit @p canvas is written.  @p offset is where the top-left corner of the quadrant would be
+ * within the full @p w x @p h augmented image.
+ *
+ * @since 2026-10-18
+ */
+void mosaic_data_augmentation(const cv::Mat & mat, cv::Mat & canvas, const cv::Rect & quadrant, const cv::Point & offset,
+    int w, int h, int pleft, int ptop, int swidth, int sheight, int flip,
+    float dhue, float dsat, float dexp,
+    int gaussian_noise, int blur, int num_boxes, int truth_size, float *truth);
+
 // blend two images with (alpha and beta)
 void blend_images_cv(Darknet::Image new_img, float alpha, Darknet::Image old_img, float beta);
 
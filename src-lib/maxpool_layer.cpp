@@ -258,10 +258,10 @@ void forward_maxpool_layer(Darknet::Layer & l, Darknet::NetworkState state)
 
 	if (l.maxpool_depth)
 	{
-		int b, i, j, k, g;
+		int b;
 		for (b = 0; b < l.batch; ++b) {
-			#pragma omp parallel for
-			for (i = 0; i < l.h; ++i) {
+			Darknet::parallel_for(0, l.h, [&](const int i) {
+				int j, k, g;
 				for (j = 0; j < l.w; ++j) {
 					for (g = 0; g < l.out_c; ++g)
 					{
@@ -281,7 +281,7 @@ void forward_maxpool_layer(Darknet::Layer & l, Darknet::NetworkState state)
 						if (l.indexes) l.indexes[out_index] = max_i;
 					}
 				}
-			}
+			}, 1);
 		}
 		return;
 	}
@@ -346,15 +346,13 @@ void backward_maxpool_layer(Darknet::Layer & l, Darknet::NetworkState state)
 {
 	TAT(TATPARMS);
 
-	int i;
 	int h = l.out_h;
 	int w = l.out_w;
 	int c = l.out_c;
-	#pragma omp parallel for
-	for(i = 0; i < h*w*c*l.batch; ++i){
+	Darknet::parallel_for(0, h*w*c*l.batch, [&](const int i) {
 		int index = l.indexes[i];
 		state.delta[index] += l.delta[i];
-	}
+	}, 1024);
 }
 
 
@@ -71,20 +71,16 @@ void forward_scale_channels_layer(Darknet::Layer & l, Darknet::NetworkState stat
 	float *from_output = state.net.layers[l.index].output;
 
 	if (l.scale_wh) {
-		int i;
-		#pragma omp parallel for
-		for (i = 0; i < size; ++i) {
+		Darknet::parallel_for(0, size, [&](const int i) {
 			int input_index = i % channel_size + (i / batch_size)*channel_size;
 
 			l.output[i] = state.input[input_index] * from_output[i];
-		}
+		}, 1024);
 	}
 	else {
-		int i;
-		#pragma omp parallel for
-		for (i = 0; i < size; ++i) {
+		Darknet::parallel_for(0, size, [&](const int i) {
 			l.output[i] = state.input[i / channel_size] * from_output[i];
-		}
+		}, 1024);
 	}
 
 	activate_array(l.output, l.outputs*l.batch, l.activation);
@@ -105,24 +101,20 @@ void backward_scale_channels_layer(Darknet::Layer & l, Darknet::NetworkState sta
 	float *from_delta = state.net.layers[l.index].delta;
 
 	if (l.scale_wh) {
-		int i;
-		#pragma omp parallel for
-		for (i = 0; i < size; ++i) {
+		Darknet::parallel_for(0, size, [&](const int i) {
 			int input_index = i % channel_size + (i / batch_size)*channel_size;
 
 			state.delta[input_index] += l.delta[i] * from_output[i];// / l.out_c; // l.delta * from  (should be divided by l.out_c?)
 
 			from_delta[i] += state.input[input_index] * l.delta[i]; // input * l.delta
-		}
+		}, 1024);
 	}
 	else {
-		int i;
-		#pragma omp parallel for
-		for (i = 0; i < size; ++i) {
+		Darknet::parallel_for(0, size, [&](const int i) {
 			state.delta[i / channel_size] += l.delta[i] * from_output[i];// / channel_size; // l.delta * from  (should be divided by channel_size?)
 
 			from_delta[i] += state.input[i / channel_size] * l.delta[i]; // input * l.delta
-		}
+		}, 1024);
 	}
 }
 
@@ -182,10 +182,9 @@ void forward_shortcut_layer(Darknet::Layer & l, Darknet::NetworkState state)
 
 	if (l.nweights == 0 && l.n == 1 && from_w == l.w && from_h == l.h && from_c == l.c) {
 		int size = l.batch * l.w * l.h * l.c;
-		int i;
-		#pragma omp parallel for
-		for(i = 0; i < size; ++i)
+		Darknet::parallel_for(0, size, [&](const int i) {
 			l.output[i] = state.input[i] + state.net.layers[l.index].output[i];
+		}, 1024);
 	}
 	else {
 		shortcut_multilayer_cpu(l.outputs * l.batch, l.outputs, l.batch, l.n, l.input_sizes, l.layers_output, l.output, state.input, l.weights, l.nweights, l.weights_normalization);
@@ -1124,6 +1124,73 @@ size_t rand_size_t()
 			((size_t)(random_gen()&0xff) << 0);
 }
 
+namespace
+{
+	inline std::mt19937 & get_rnd_engine()
+	{
+		TAT(TATPARMS);
+
+		// we must have 1 per thread of these (use random_device to seed the engine)
+		static thread_local std::mt19937 rnd_engine(std::random_device{}());
+
+		return rnd_engine;
+	}
+
+
+	/** A counter-based random number stream.  Each value depends only on the key and the counter, so the same key
+	 * always produces the same sequence no matter which thread uses it.  @see @ref set_rng_stream()
+	 */
+	struct RngStream
+	{
+		bool		active	= false;
+		uint64_t	key		= 0;
+		uint64_t	counter	= 0;
+	};
+
+	static thread_local RngStream rng_stream;
+
+
+	/// The splitmix64 finalizer, which turns consecutive integers into well-distributed 64-bit values.
+	static inline uint64_t splitmix64(uint64_t x)
+	{
+		x += 0x9e3779b97f4a7c15ULL;
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+		return x ^ (x >> 31);
+	}
+
+
+	static inline uint64_t next_rng_stream_value()
+	{
+		return splitmix64(rng_stream.key + 0x9e3779b97f4a7c15ULL * rng_stream.counter ++);
+	}
+}
+
+
+void set_rng_stream(const uint64_t seed, const uint64_t stream)
+{
+	TAT(TATPARMS);
+
+	rng_stream.active	= true;
+	rng_stream.key		= splitmix64(seed ^ splitmix64(stream));
+	rng_stream.counter	= 0;
+
+	// OpenCV has its own per-thread generator which is used for things like the gaussian noise
+	cv::theRNG().state = next_rng_stream_value();
+
+	return;
+}
+
+
+void clear_rng_stream()
+{
+	TAT(TATPARMS);
+
+	rng_stream.active = false;
+
+	return;
+}
+
 float rand_uniform(float min, float max)
 {
 	TAT(TATPARMS);
@@ -1133,6 +1200,11 @@ float rand_uniform(float min, float max)
 		std::swap(min, max);
 	}
 
+	if (rng_stream.active)
+	{
+		return (random_float() * (max - min)) + min;
+	}
+
 #if (RAND_MAX < 65536)
 		int rnd = rand()*(RAND_MAX + 1) + rand();
 		return ((float)rnd / (RAND_MAX*RAND_MAX) * (max - min)) + min;
@@ -1165,19 +1237,6 @@ float **one_hot_encode(float *a, int n, int k)
 	return t;
 }
 
-namespace
-{
-	inline std::mt19937 & get_rnd_engine()
-	{
-		TAT(TATPARMS);
-
-		// we must have 1 per thread of these (use random_device to seed the engine)
-		static thread_local std::mt19937 rnd_engine(std::random_device{}());
-
-		return rnd_engine;
-	}
-}
-
 // Marsaglia's xorshf96 generator: period 2^96-1
 unsigned int random_gen_fast(void)
 {
@@ -1227,6 +1286,13 @@ unsigned int random_gen(unsigned int min, unsigned int max)
 {
 	TAT(TATPARMS);
 
+	if (rng_stream.active)
+	{
+		// std::uniform_int_distribution is not the same across C++ libraries, so it cannot be used to reproduce results
+		const uint64_t range = static_cast<uint64_t>(max) - min + 1;
+		return min + static_cast<unsigned int>(next_rng_stream_value() % range);
+	}
+
 	std::uniform_int_distribution<unsigned int> distribution(min, max);
 
 	return distribution(get_rnd_engine());
@@ -1237,6 +1303,12 @@ float random_float()
 {
 	TAT(TATPARMS);
 
+	if (rng_stream.active)
+	{
+		// use the top 24 bits since that is all the precision a float has
+		return static_cast<float>(next_rng_stream_value() >> 40) / static_cast<float>((1 << 24) - 1);
+	}
+
 	unsigned int rnd = 0;
 #ifdef WIN32
 	rand_s(&rnd);
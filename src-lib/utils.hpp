@@ -89,6 +89,21 @@ unsigned int random_gen_fast(void);
 float random_float_fast();
 int rand_int_fast(int min, int max);
 unsigned int random_gen(unsigned int min=0, unsigned int max=std::numeric_limits<unsigned int>::max());
+
+/** Make @ref random_gen(), @ref random_float(), and the functions built on them -- such as @ref rand_int(),
+ * @ref rand_uniform(), and @ref rand_scale() -- use a counter-based stream on the current thread.  The values only
+ * depend on @p seed and @p stream, so the same images are always augmented the same way regardless of which thread
+ * loads them.  This only affects the calling thread.
+ *
+ * @see @ref clear_rng_stream()
+ *
+ * @since 2026-10-18
+ */
+void set_rng_stream(const uint64_t seed, const uint64_t stream);
+
+/// Go back to the non-deterministic random numbers on the current thread.  @since 2026-10-18
+void clear_rng_stream();
+
 float random_float();
 float rand_uniform_strong(float min, float max);
 float rand_precalc_random(float min, float max, float random_part);